@@ -1,84 +0,0 @@
-#ifndef MAINWINDOW_HPP
-#define MAINWINDOW_HPP
-
-#include <QMainWindow>
-#include <QFileDialog>
-#include <QPushButton>
-#include <QBoxLayout>
-#include <QSpinBox>
-#include <QLabel>
-#include <QGroupBox>
-#include <QStatusBar>
-#include <QCheckBox>
-
-#include "QtOpencvCore.hpp"
-#include "opencv2/core/core.hpp"
-#include "opencv2/highgui/highgui.hpp"
-
-
-class MainWindow : public QMainWindow
-{
-    Q_OBJECT
-    
-public:
-    
-    /* Konstruktor */
-    explicit MainWindow(QWidget *parent = 0);
-    
-    /* Destruktor */
-    ~MainWindow();
-    
-private slots:  
-    
-    /* Funktionen werden ausgeloest, wenn auf den entsprechenden Button geklickt wird */
-    void on_pbOpenImage_clicked();
-    void on_pbComputeSeams_clicked();
-    void on_pbRemoveSeams_clicked();
-    
-private:
-
-    
-    /* UI Komponenten */
-    QWidget     *centralWidget;
-    
-    QHBoxLayout *horizontalLayout;
-    QHBoxLayout *horizontalLayout_2;
-    QHBoxLayout *horizontalLayout_3;
-    QVBoxLayout *verticalLayout;
-    QVBoxLayout *verticalLayout_3;
-    
-    QPushButton *pbOpenImage;
-    QPushButton *pbRemoveSeams;
-    QPushButton *pbComputeSeams;
-    
-    QLabel      *lCaption;
-    QLabel      *lCols;
-    QLabel      *lRows;
-    
-    QSpinBox    *sbCols;
-    QSpinBox    *sbRows;
-    
-    QSpacerItem *verticalSpacer;
-    QSpacerItem *horizontalSpacer;
-
-	QCheckBox *cbMark;
-    /*****************************************/
-    
-    /* Originalbild */
-    cv::Mat         originalImage;
-    /* Eventuell weitere Klassenattribute */
-	cv::Mat			gray;
-	cv::Mat			energy;
-	cv::Mat			carved;
-	std::vector<std::vector<int>> horizontal_seams{};
-	std::vector<std::vector<int>> vertical_seams{};
-
-    /* Methode initialisiert die UI */
-    void setupUi();
-    
-    /* Methoden aktivieren bzw. deaktivieren die UI */
-    void enableGUI();
-    void disableGUI();
-};
-
-#endif // MAINWINDOW_HPP
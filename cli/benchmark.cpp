@@ -0,0 +1,326 @@
+#include "benchmark.h"
+
+#include "cv_utility.h"
+#include "energy_policy.h"
+#include "route_matrix.h"
+#include "seam_carver.h"
+#include "seam_kernel.h"
+#include "seam_list.h"
+#include "seam_pyramid.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+	template<typename F>
+	/**
+	 * @brief fastest Runs an operation several times.
+	 * @param repetitions The number of runs.
+	 * @param operation The operation.
+	 * @return The duration of the fastest run in seconds.
+	 */
+	double fastest(int repetitions, F&& operation)
+	{
+		auto best = std::chrono::duration<double>::max();
+		for(int i = 0; i < std::max(repetitions, 1); ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			operation();
+			best = std::min<std::chrono::duration<double>>(best, std::chrono::steady_clock::now() - start);
+		}
+		return best.count();
+	}
+
+	/**
+	 * @brief report Prints one line of the result table.
+	 * @param name The operation.
+	 * @param seconds The duration of one run.
+	 * @param pixels The number of pixels processed in one run.
+	 */
+	void report(const std::string& name, double seconds, double pixels)
+	{
+		std::cout << std::left << std::setw(36) << name << std::right << std::fixed
+				  << std::setw(10) << std::setprecision(3) << seconds * 1e3 << " ms"
+				  << std::setw(10) << std::setprecision(1) << pixels / seconds * 1e-6 << " MPixel/s" << std::endl;
+	}
+
+	/**
+	 * @brief original_vertical_seam The vertical seam search of the original code, kept as reference for its throughput.
+	 * Every row starts hardware_concurrency() new threads that take every thread_count-th column and joins them again.
+	 * Every cell calls the comparator through std::function twice and writes its route with the bounds-checked at<>().
+	 * @param image The 8UC1 energy map, at least two columns wide.
+	 * @param compare Whether the first cumulative energy is better than the second.
+	 * @return The column of the seam in every row.
+	 */
+	std::vector<int> original_vertical_seam(const cv::Mat& image, std::function<bool(int, int)> compare)
+	{
+		auto routes = cv::Mat(image.size(), CV_8SC1);
+		auto current = std::vector<int>(static_cast<size_t>(image.cols), 0);
+		auto last = std::vector<int>(static_cast<size_t>(image.cols));
+		for(int c = 0; c < image.cols; ++c)
+			last[static_cast<size_t>(c)] = image.at<uchar>(0, c);
+
+		const auto thread_count = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, image.cols);
+		auto threads = std::vector<std::thread>{};
+		for(int r = 1; r < image.rows; ++r)
+		{
+			for(int t = 0; t < thread_count; ++t)
+			{
+				threads.emplace_back([t, thread_count, r, &image, &current, &last, &routes, &compare] () {
+					for(int c = t; c < image.cols; c += thread_count)
+					{
+						current[static_cast<size_t>(c)] = last[static_cast<size_t>(c)];
+						routes.at<signed char>(r, c) = 0;
+						if(c-1 >= 0 && compare(last[static_cast<size_t>(c-1)], current[static_cast<size_t>(c)]))
+						{
+							current[static_cast<size_t>(c)] = last[static_cast<size_t>(c-1)];
+							routes.at<signed char>(r, c) = -1;
+						}
+						if(c+1 < image.cols && compare(last[static_cast<size_t>(c+1)], current[static_cast<size_t>(c)]))
+						{
+							current[static_cast<size_t>(c)] = last[static_cast<size_t>(c+1)];
+							routes.at<signed char>(r, c) = 1;
+						}
+						current[static_cast<size_t>(c)] += image.at<uchar>(r, c);
+					}
+				});
+			}
+			for(auto& thread : threads)
+				thread.join();
+			threads.clear();
+			current.swap(last);
+		}
+
+		auto seam = std::vector<int>(static_cast<size_t>(image.rows), 0);
+		auto col = static_cast<int>(std::max_element(last.begin(), last.end(), [&compare] (const auto& a, const auto& b) { return !compare(a,b); }) - last.begin());
+		for(int r = routes.rows-1; r >= 0; --r)
+		{
+			seam[static_cast<size_t>(r)] = col;
+			col += static_cast<int>(routes.at<signed char>(r, col));
+		}
+		return seam;
+	}
+
+	/**
+	 * @brief pooled_vertical_seam The per-cell loop of original_vertical_seam on the persistent thread pool, as it ran before
+	 * the SIMD row kernel: one contiguous block of columns per pool thread and a barrier after every row.
+	 * @param image The 8UC1 energy map, at least two columns wide.
+	 * @param compare Whether the first cumulative energy is better than the second.
+	 * @return The column of the seam in every row.
+	 */
+	std::vector<int> pooled_vertical_seam(const cv::Mat& image, std::function<bool(int, int)> compare)
+	{
+		auto routes = cv::Mat(image.size(), CV_8SC1);
+		auto current = std::vector<int>(static_cast<size_t>(image.cols), 0);
+		auto last = std::vector<int>(static_cast<size_t>(image.cols));
+		for(int c = 0; c < image.cols; ++c)
+			last[static_cast<size_t>(c)] = image.at<uchar>(0, c);
+
+		// Multithreading, one block of columns per thread and a barrier after every row
+		auto& pool = cvutil::thread_pool();
+		auto barrier = cvutil::Barrier{pool.clamp_tasks(image.cols)};
+
+		pool.run(image.cols, [&image, &current, &last, &routes, &compare, &barrier] (int t, int thread_count) {
+			const int start = image.cols * t / thread_count;
+			const int end = image.cols * (t+1) / thread_count;
+
+			auto* cur = &current;
+			auto* prev = &last;
+			for(int r = 1; r < image.rows; ++r)
+			{
+				for(int c = start; c < end; ++c)
+				{
+					(*cur)[static_cast<size_t>(c)] = (*prev)[static_cast<size_t>(c)];
+					routes.at<signed char>(r, c) = 0;
+					if(c-1 >= 0 && compare((*prev)[static_cast<size_t>(c-1)], (*cur)[static_cast<size_t>(c)]))
+					{
+						(*cur)[static_cast<size_t>(c)] = (*prev)[static_cast<size_t>(c-1)];
+						routes.at<signed char>(r, c) = -1;
+					}
+					if(c+1 < image.cols && compare((*prev)[static_cast<size_t>(c+1)], (*cur)[static_cast<size_t>(c)]))
+					{
+						(*cur)[static_cast<size_t>(c)] = (*prev)[static_cast<size_t>(c+1)];
+						routes.at<signed char>(r, c) = 1;
+					}
+					(*cur)[static_cast<size_t>(c)] += image.at<uchar>(r, c);
+				}
+				barrier.wait();
+				std::swap(cur, prev);
+			}
+		});
+		// Every thread swapped its pointers once per row, the vectors themselves were not swapped yet
+		if(image.rows % 2 == 0)
+			current.swap(last);
+
+		auto seam = std::vector<int>(static_cast<size_t>(image.rows), 0);
+		auto col = static_cast<int>(std::max_element(last.begin(), last.end(), [&compare] (const auto& a, const auto& b) { return !compare(a,b); }) - last.begin());
+		for(int r = routes.rows-1; r >= 0; --r)
+		{
+			seam[static_cast<size_t>(r)] = col;
+			col += static_cast<int>(routes.at<signed char>(r, col));
+		}
+		return seam;
+	}
+}
+
+void cli::run_benchmark(const cv::Mat& image, int repetitions)
+{
+	const auto pixels = static_cast<double>(image.total());
+	std::cout << "Image " << image.cols << "x" << image.rows << ", " << cvutil::thread_pool().size() << " threads, best of "
+			  << std::max(repetitions, 1) << " runs" << std::endl;
+
+	auto gray = cv::Mat{};
+	report("grayscale", fastest(repetitions, [&] { gray = cvutil::grayscale(image); }), pixels);
+
+	auto energy = cv::Mat{};
+	report("energy (Sobel)", fastest(repetitions, [&] { energy = cvutil::energy(gray); }), pixels);
+	report("grayscale + energy fused", fastest(repetitions, [&] { cvutil::gray_energy(image, gray, energy); }), pixels);
+	report("energy fused, no gray image", fastest(repetitions, [&] { energy = cvutil::gray_energy(image); }), pixels);
+
+	// The energy policies, one kernel object per thread and row, no call per pixel through a pointer
+	{
+		auto map = cv::Mat{};
+		report("energy policy Sobel", fastest(repetitions, [&] { map = cvutil::energy_map<cvutil::SobelEnergy>(gray); }), pixels);
+		report("energy policy color gradient", fastest(repetitions, [&] { map = cvutil::energy_map<cvutil::ColorGradientEnergy>(image); }), pixels);
+		report("energy policy entropy 5x5", fastest(repetitions, [&] { map = cvutil::energy_map<cvutil::EntropyEnergy>(gray); }), pixels);
+		report("energy policy saliency 9x9", fastest(repetitions, [&] { map = cvutil::energy_map<cvutil::SaliencyEnergy>(gray); }), pixels);
+	}
+
+	// The original search starts threads per row, the pooled one runs the same per-cell loop on the thread pool. Both call a
+	// lambda through std::function twice per cell, like the std::function overload. The policies are inlined, MinSeam<int>
+	// runs the SIMD row kernel and has to find the seam of the original search.
+	auto seam = std::vector<int>{};
+	report("vertical seam original per cell", fastest(repetitions, [&] {
+		seam = original_vertical_seam(energy, [] (int a, int b) { return a < b; });
+	}), pixels);
+	const auto baseline = seam;
+	report("vertical seam pooled per cell", fastest(repetitions, [&] {
+		seam = pooled_vertical_seam(energy, [] (int a, int b) { return a < b; });
+	}), pixels);
+	if(seam != baseline)
+		std::cout << "ERROR: The pooled per-cell search found another seam than the original one." << std::endl;
+	report("vertical seam std::function", fastest(repetitions, [&] {
+		seam = cvutil::vertical_seam(energy, [] (int a, int b) { return a < b; });
+	}), pixels);
+	report("vertical seam MinSeam<int> (SIMD)", fastest(repetitions, [&] { seam = cvutil::vertical_seam<cvutil::MinSeam, int>(energy); }), pixels);
+	if(seam != baseline)
+		std::cout << "ERROR: The SIMD row kernel found another seam than the original search." << std::endl;
+	report("vertical seam MinSeam<uint16_t>", fastest(repetitions, [&] { seam = cvutil::vertical_seam<cvutil::MinSeam, uint16_t>(energy); }), pixels);
+	report("vertical seam MinSeam<float>", fastest(repetitions, [&] { seam = cvutil::vertical_seam<cvutil::MinSeam, float>(energy); }), pixels);
+	report("vertical seam MaxSeam<int>", fastest(repetitions, [&] { seam = cvutil::vertical_seam<cvutil::MaxSeam, int>(energy); }), pixels);
+	report("horizontal seam", fastest(repetitions, [&] { seam = cvutil::horizontal_seam(energy); }), pixels);
+	report("vertical seam forward energy (SIMD)", fastest(repetitions, [&] { seam = cvutil::vertical_seam(gray, cvutil::EnergyMode::forward); }), pixels);
+
+	// A protected and a removed quarter of the image, the blocks of 16 cells without a label are skipped by the bias kernel
+	const auto protected_rows = cv::Range(image.rows / 4, image.rows / 2);
+	const auto protected_cols = cv::Range(image.cols / 4, image.cols / 2);
+	const auto removed_rows = cv::Range(image.rows / 2, image.rows * 3 / 4);
+	const auto removed_cols = cv::Range(image.cols / 2, image.cols * 3 / 4);
+	auto labels = cv::Mat(energy.size(), CV_8UC1, cv::Scalar::all(0));
+	labels(protected_rows, protected_cols).setTo(cv::Scalar::all(static_cast<int>(cvutil::SeamMask::protect)));
+	labels(removed_rows, removed_cols).setTo(cv::Scalar::all(static_cast<int>(cvutil::SeamMask::remove)));
+	report("vertical seam with mask bias", fastest(repetitions, [&] { seam = cvutil::vertical_seam(energy, labels); }), pixels);
+
+	// Scaling of the tiled seam search over the thread count, the threads only synchronize once per band of rows
+	{
+		const auto threads = cvutil::thread_pool().size();
+		for(const auto count : {1, 2, 4, 8, 16, 32})
+		{
+			cvutil::set_thread_count(count);
+			report("vertical seam " + std::to_string(count) + " threads", fastest(repetitions, [&] {
+				seam = cvutil::vertical_seam<cvutil::MinSeam, int>(energy);
+			}), pixels);
+		}
+		cvutil::set_thread_count(threads);
+	}
+
+	// Route storage on one thread: a byte per cell against 2 bits per cell, both with the SIMD row kernel and the backtrack
+	{
+		auto rows = std::vector<int>(static_cast<size_t>(energy.cols) * 2);
+		auto byte_routes = cv::Mat(energy.size(), CV_8SC1);
+		report("routes byte per cell (" + std::to_string(byte_routes.total() >> 20) + " MiB)", fastest(repetitions, [&] {
+			for(int r = 1; r < energy.rows; ++r)
+				cvutil::kernel::relax_row(rows.data() + (r-1) % 2 * energy.cols, energy.ptr<uchar>(r), rows.data() + r % 2 * energy.cols,
+										  byte_routes.ptr<signed char>(r), 0, energy.cols, energy.cols);
+			auto col = 0;
+			for(int r = energy.rows-1; r > 0; --r)
+				col += byte_routes.at<signed char>(r, col);
+			seam.assign(1, col);
+		}), pixels);
+
+		auto packed_routes = cvutil::RouteMatrix{};
+		packed_routes.create(energy.rows, energy.cols);
+		auto offsets = std::vector<signed char>(static_cast<size_t>(energy.cols));
+		report("routes 2 bits per cell (" + std::to_string(packed_routes.bytes() >> 20) + " MiB)", fastest(repetitions, [&] {
+			for(int r = 1; r < energy.rows; ++r)
+			{
+				cvutil::kernel::relax_row(rows.data() + (r-1) % 2 * energy.cols, energy.ptr<uchar>(r), rows.data() + r % 2 * energy.cols,
+										  offsets.data(), 0, energy.cols, energy.cols);
+				cvutil::pack_routes(offsets.data(), packed_routes.ptr(r), 0, energy.cols);
+			}
+			packed_routes.backtrack(0, seam);
+		}), pixels);
+	}
+
+	// Throughput counts the full resolution, the pyramid only searches a band of it
+	auto pyramid = cvutil::PyramidSeamFinder{3, 4};
+	report("vertical seam pyramid 3 levels", fastest(repetitions, [&] { seam = pyramid.seam(energy); }), pixels);
+
+	// Carving 10% of the columns, throughput counts the pixels searched over all seams
+	const auto count = std::max(image.cols / 10, 1);
+	auto searched = 0.0;
+	for(int i = 0; i < count; ++i)
+		searched += static_cast<double>(image.rows) * (image.cols - i);
+	report("carve " + std::to_string(count) + " vertical seams", fastest(repetitions, [&] {
+		auto carver = cvutil::SeamCarver{image};
+		carver.carve(count, cvutil::Orientation::vertical);
+	}), searched);
+	report("carve " + std::to_string(count) + " seams forward energy", fastest(repetitions, [&] {
+		auto carver = cvutil::SeamCarver{image, cvutil::EnergyMode::forward};
+		carver.carve(count, cvutil::Orientation::vertical);
+	}), searched);
+	report("carve " + std::to_string(count) + " seams pyramid 3 levels", fastest(repetitions, [&] {
+		auto carver = cvutil::SeamCarver{image};
+		carver.coarse_to_fine(3, 4);
+		carver.carve(count, cvutil::Orientation::vertical);
+	}), searched);
+	report("carve " + std::to_string(count) + " seams with masks", fastest(repetitions, [&] {
+		auto protect = cv::Mat(image.size(), CV_8UC1, cv::Scalar::all(0));
+		auto remove = protect.clone();
+		protect(protected_rows, protected_cols).setTo(cv::Scalar::all(255));
+		remove(removed_rows, removed_cols).setTo(cv::Scalar::all(255));
+
+		auto carver = cvutil::SeamCarver{image};
+		carver.set_masks(protect, remove);
+		carver.carve(count, cvutil::Orientation::vertical);
+	}), searched);
+
+	// Removing the carved seams from the original in one pass, the seams held as vectors against delta encoded ones
+	{
+		auto carver = cvutil::SeamCarver{image};
+		auto vectors = std::vector<std::vector<int>>{};
+		auto list = cvutil::SeamList{};
+		auto vector_bytes = size_t{0};
+		for(int i = 0; i < count; ++i)
+		{
+			vectors.push_back(carver.step(cvutil::Orientation::vertical));
+			list.push_back(vectors.back());
+			vector_bytes += sizeof(vectors.back()) + vectors.back().capacity() * sizeof(int);
+		}
+
+		auto carved = cv::Mat{};
+		report("remove seams vectors (" + std::to_string(vector_bytes >> 10) + " KiB)", fastest(repetitions, [&] {
+			carved = cvutil::remove_vertical_seams<cv::Vec<uchar, 3>>(image, vectors);
+		}), pixels);
+		report("remove seams delta encoded (" + std::to_string(list.bytes() >> 10) + " KiB)", fastest(repetitions, [&] {
+			carved = cvutil::remove_vertical_seams<cv::Vec<uchar, 3>>(image, list);
+		}), pixels);
+	}
+}
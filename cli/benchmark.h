@@ -0,0 +1,17 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "opencv2/core/core.hpp"
+
+namespace cli
+{
+	/**
+	 * @brief run_benchmark Times the core operations on one image and prints their throughput.
+	 * Every operation runs repetitions times, the fastest run is reported.
+	 * @param image The 8UC3 image to measure with.
+	 * @param repetitions The number of runs per operation, at least 1.
+	 */
+	void run_benchmark(const cv::Mat& image, int repetitions);
+}
+
+#endif // BENCHMARK_H
@@ -0,0 +1,78 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace cli
+{
+	template<typename T>
+	/**
+	 * @brief The BoundedQueue class A blocking FIFO queue with a fixed capacity for handing work between pipeline stages.
+	 * A full queue blocks the producer, so a fast stage cannot run ahead and hold more than capacity items in memory.
+	 */
+	class BoundedQueue
+	{
+	public:
+		/**
+		 * @brief BoundedQueue Creates an empty queue.
+		 * @param capacity The maximum number of queued items, at least 1.
+		 */
+		explicit BoundedQueue(size_t capacity) : capacity{capacity < 1 ? 1 : capacity} {}
+
+		/**
+		 * @brief push Appends an item, waits while the queue is full.
+		 * @param item The item.
+		 * @return false if the queue was closed, the item is dropped then.
+		 */
+		bool push(T item)
+		{
+			auto lock = std::unique_lock<std::mutex>{mutex};
+			not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+			if(closed)
+				return false;
+			items.push_back(std::move(item));
+			not_empty.notify_one();
+			return true;
+		}
+
+		/**
+		 * @brief pop Removes the oldest item, waits while the queue is empty and open.
+		 * @return The item, or nothing once the queue is closed and drained.
+		 */
+		std::optional<T> pop()
+		{
+			auto lock = std::unique_lock<std::mutex>{mutex};
+			not_empty.wait(lock, [this] { return closed || !items.empty(); });
+			if(items.empty())
+				return std::nullopt;
+			auto item = std::optional<T>{std::move(items.front())};
+			items.pop_front();
+			not_full.notify_one();
+			return item;
+		}
+
+		/**
+		 * @brief close Ends the input. Queued items can still be popped, further pushes fail.
+		 */
+		void close()
+		{
+			auto lock = std::lock_guard<std::mutex>{mutex};
+			closed = true;
+			not_empty.notify_all();
+			not_full.notify_all();
+		}
+
+	private:
+		const size_t capacity;
+		std::deque<T> items{};
+		bool closed{false};
+		std::mutex mutex{};
+		std::condition_variable not_empty{};
+		std::condition_variable not_full{};
+	};
+}
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Seam carving command-line tool, no Qt dependency
+#
+#-------------------------------------------------
+
+CONFIG += c++1z console
+CONFIG -= app_bundle
+
+QT -= core gui
+
+TARGET = seamcarve
+TEMPLATE = app
+
+
+SOURCES += main.cpp \
+    benchmark.cpp
+
+HEADERS  += bounded_queue.h \
+    benchmark.h
+
+include(../core/core.pri)
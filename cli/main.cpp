@@ -0,0 +1,647 @@
+#include "benchmark.h"
+#include "bounded_queue.h"
+
+#include "cv_utility.h"
+#include "seam_carver.h"
+#include "seam_order.h"
+#include "seam_schedule.h"
+#include "stream_carver.h"
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/imgcodecs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	const auto usage = R"(Usage: seamcarve [options] <input> <output>
+       seamcarve --save-order <file> (--width <n> | --height <n>) <input>
+       seamcarve --order <file> (--width <n> | --height <n>) <input> <output>
+       seamcarve --stream <MiB> --width <n> <input.ppm> <output.ppm>
+       seamcarve --benchmark [--repeat <n>] [--threads <n>] <input>
+
+Carves an image file, or every image of the input directory into the output directory.
+
+Options:
+  -W, --width <n>     Target width in pixels, larger than the input inserts seams (default: unchanged)
+  -H, --height <n>    Target height in pixels, larger than the input inserts seams (default: unchanged)
+  -f, --forward       Searches seams with forward energy, which avoids new edges where the
+                      removed seam joins its neighbours (default: backward energy)
+  -e, --energy <name>
+                      Energy function of backward energy: sobel, color (gradients of every color
+                      channel), entropy (5x5 gray value entropy) or saliency (contrast against
+                      the 9x9 surround). Also used by --optimal-order, --save-order and seam
+                      insertion, not by --forward or --stream (default: sobel)
+  -P, --protect <file>
+                      Mask image of the input, seams avoid its non-zero pixels
+  -R, --remove <file> Mask image of the input, vertical seams are removed until none of its
+                      non-zero pixels is left, before carving to --width and --height
+  -O, --optimal-order Interleaves vertical and horizontal seams in the order of the greedy transport
+                      map, reports its cost and time against removing all vertical seams first and
+                      carves the cheaper of both orders, refused if its map does not fit into
+                      the installed memory (default: vertical seams first)
+  -p, --pyramid <n>   Searches seams coarse to fine on n halved levels, refining them in a band
+                      at every finer level, and reports energy and time against the exact
+                      full resolution search (default: 0, exact search only)
+  -B, --band <n>      Pixels searched to both sides of the refined seam (default: 4)
+  -t, --threads <n>   Threads per carving job, 0 uses all cores (default: 0)
+  -q, --queue <n>     Decoded and carved images in flight between the pipeline stages
+                      of directory mode (default: 2)
+  -s, --save-order <file>
+                      Carves the input once down to the given width or height and saves the
+                      removal order of every pixel
+  -o, --order <file>  Retargets the input to any width or height between that minimum and the
+                      original size plus as many inserted seams in one pass, using an order
+                      saved with --save-order
+  -m, --stream <MiB>  Carves a binary PPM file to the given width with at most that much memory
+                      for pixels and buffers, mapping the files in strips of rows
+  -b, --benchmark     Times the core operations on the input image
+  -r, --repeat <n>    Runs per operation of the benchmark (default: 5)
+  -h, --help          Shows this text
+)";
+
+	struct Options
+	{
+		fs::path input{};
+		fs::path output{};
+		int width{0};		// 0 keeps the width
+		int height{0};		// 0 keeps the height
+		cvutil::EnergyMode mode{cvutil::EnergyMode::backward};
+		cvutil::EnergyKernel energy{cvutil::EnergyKernel::sobel};
+		std::string protect{};	// Mask files, empty for none
+		std::string remove{};
+		bool optimal_order{false};
+		int pyramid{0};		// 0 searches the full resolution
+		int band{4};
+		int threads{0};
+		int queue{2};
+		std::string save_order{};
+		std::string order{};
+		int stream{0};		// MiB, 0 carves in memory
+		bool benchmark{false};
+		int repeat{5};
+	};
+
+	/**
+	 * @brief The Job struct One image on its way through the directory pipeline.
+	 */
+	struct Job
+	{
+		fs::path source{};
+		fs::path target{};
+		cv::Mat image{};
+		double seconds{0.0};	// Carving time
+	};
+
+	/**
+	 * @brief log Prints a line, lines of concurrent pipeline stages do not interleave.
+	 */
+	void log(std::ostream& stream, const std::string& line)
+	{
+		static auto mutex = std::mutex{};
+		auto lock = std::lock_guard<std::mutex>{mutex};
+		stream << line << std::endl;
+	}
+
+	/**
+	 * @brief to_count Parses a non-negative integer option value.
+	 * @throws std::invalid_argument if the value is missing, not a number or negative.
+	 */
+	int to_count(const std::string& option, const char* value)
+	{
+		if(value == nullptr)
+			throw std::invalid_argument{"Missing value for " + option};
+
+		auto end = size_t{0};
+		auto count = -1;
+		try
+		{
+			count = std::stoi(value, &end);
+		}
+		catch(const std::exception&)
+		{
+		}
+		if(count < 0 || value[end] != '\0')
+			throw std::invalid_argument{"Invalid value for " + option + ": " + value};
+		return count;
+	}
+
+	/**
+	 * @brief to_path Checks that a path option has a value.
+	 * @throws std::invalid_argument if the value is missing.
+	 */
+	std::string to_path(const std::string& option, const char* value)
+	{
+		if(value == nullptr || *value == '\0')
+			throw std::invalid_argument{"Missing value for " + option};
+		return value;
+	}
+
+	/**
+	 * @brief to_energy Parses the name of an energy function.
+	 * @throws std::invalid_argument if the value is missing or unknown.
+	 */
+	cvutil::EnergyKernel to_energy(const std::string& option, const char* value)
+	{
+		const auto name = to_path(option, value);
+		if(name == "sobel")
+			return cvutil::EnergyKernel::sobel;
+		if(name == "color")
+			return cvutil::EnergyKernel::color_gradient;
+		if(name == "entropy")
+			return cvutil::EnergyKernel::entropy;
+		if(name == "saliency")
+			return cvutil::EnergyKernel::saliency;
+		throw std::invalid_argument{"Invalid value for " + option + ": " + name};
+	}
+
+	/**
+	 * @brief parse Reads the command line.
+	 * @throws std::invalid_argument for unknown options, invalid values and missing paths.
+	 */
+	Options parse(int argc, char* argv[])
+	{
+		auto options = Options{};
+		auto paths = std::vector<std::string>{};
+		for(int i = 1; i < argc; ++i)
+		{
+			const auto arg = std::string{argv[i]};
+			const auto value = [&] { return i + 1 < argc ? argv[++i] : nullptr; };
+
+			if(arg == "-W" || arg == "--width")
+				options.width = to_count(arg, value());
+			else if(arg == "-H" || arg == "--height")
+				options.height = to_count(arg, value());
+			else if(arg == "-f" || arg == "--forward")
+				options.mode = cvutil::EnergyMode::forward;
+			else if(arg == "-e" || arg == "--energy")
+				options.energy = to_energy(arg, value());
+			else if(arg == "-P" || arg == "--protect")
+				options.protect = to_path(arg, value());
+			else if(arg == "-R" || arg == "--remove")
+				options.remove = to_path(arg, value());
+			else if(arg == "-O" || arg == "--optimal-order")
+				options.optimal_order = true;
+			else if(arg == "-p" || arg == "--pyramid")
+				options.pyramid = to_count(arg, value());
+			else if(arg == "-B" || arg == "--band")
+				options.band = std::max(to_count(arg, value()), 1);
+			else if(arg == "-t" || arg == "--threads")
+				options.threads = to_count(arg, value());
+			else if(arg == "-q" || arg == "--queue")
+				options.queue = std::max(to_count(arg, value()), 1);
+			else if(arg == "-s" || arg == "--save-order")
+				options.save_order = to_path(arg, value());
+			else if(arg == "-o" || arg == "--order")
+				options.order = to_path(arg, value());
+			else if(arg == "-m" || arg == "--stream")
+				options.stream = std::max(to_count(arg, value()), 1);
+			else if(arg == "-b" || arg == "--benchmark")
+				options.benchmark = true;
+			else if(arg == "-r" || arg == "--repeat")
+				options.repeat = std::max(to_count(arg, value()), 1);
+			else if(arg.size() > 1 && arg[0] == '-')
+				throw std::invalid_argument{"Unknown option " + arg};
+			else
+				paths.push_back(arg);
+		}
+
+		if(!options.save_order.empty() + !options.order.empty() + (options.stream > 0) + options.benchmark > 1)
+			throw std::invalid_argument{"--save-order, --order, --stream and --benchmark exclude each other"};
+		if(options.stream > 0 && (options.width == 0 || options.height > 0 || options.optimal_order || options.pyramid > 0))
+			throw std::invalid_argument{"--stream only carves vertical seams down to a width"};
+		if(options.optimal_order && options.pyramid > 0)
+			throw std::invalid_argument{"--optimal-order and --pyramid exclude each other"};
+		if(options.energy != cvutil::EnergyKernel::sobel && (options.mode == cvutil::EnergyMode::forward
+				|| !options.order.empty() || options.stream > 0))
+			throw std::invalid_argument{"--energy only selects backward energy, saved orders and streaming do not search seams"};
+		if((!options.protect.empty() || !options.remove.empty()) && (options.optimal_order || options.pyramid > 0
+				|| !options.save_order.empty() || !options.order.empty() || options.stream > 0))
+			throw std::invalid_argument{"--protect and --remove only bias seam carving without orders, pyramid or streaming"};
+		if((!options.save_order.empty() || !options.order.empty()) && (options.width > 0) == (options.height > 0))
+			throw std::invalid_argument{"Seam orders need either a width or a height"};
+
+		const auto input_only = options.benchmark || !options.save_order.empty();
+		if(paths.size() != (input_only ? 1u : 2u))
+			throw std::invalid_argument{input_only ? "Expected one input path" : "Expected input and output path"};
+		options.input = paths[0];
+		if(!input_only)
+			options.output = paths[1];
+		return options;
+	}
+
+	/**
+	 * @brief is_image Whether OpenCV can be expected to decode a file, judged by its extension.
+	 */
+	bool is_image(const fs::path& path)
+	{
+		static const auto extensions = std::vector<std::string>{
+			".png", ".jpg", ".jpeg", ".jpe", ".bmp", ".dib", ".tif", ".tiff", ".webp", ".ppm", ".pgm", ".pbm", ".pnm"
+		};
+		auto extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [] (unsigned char c) { return std::tolower(c); });
+		return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+	}
+
+	/**
+	 * @brief read_mask Reads a mask image of the input, every non-zero pixel is masked.
+	 * @param path The mask file, empty for no mask.
+	 * @param size The size of the input image.
+	 * @return The 8UC1 mask, empty without a path.
+	 * @throws std::runtime_error if the file cannot be read, std::invalid_argument if its size differs from the input.
+	 */
+	cv::Mat read_mask(const std::string& path, cv::Size size)
+	{
+		if(path.empty())
+			return cv::Mat{};
+
+		const auto mask = cv::imread(path, cv::IMREAD_GRAYSCALE);
+		if(mask.empty())
+			throw std::runtime_error{"Cannot read " + path};
+		if(mask.size() != size)
+			throw std::invalid_argument{"Mask " + path + " does not have the size of the image"};
+		return mask;
+	}
+
+	/**
+	 * @brief carve Removes vertical seams down to the target width, then horizontal seams down to the target height.
+	 * With --optimal-order the seams are interleaved in the order of the transport map instead, unless the fixed order costs
+	 * less. The cost and time of both orders are logged.
+	 * With --pyramid the seams are searched coarse to fine, and the summed seam energy and time are logged next to the ones
+	 * of the exact search.
+	 * A target larger than the image inserts seams: both seam orders are recorded once and applied in one pass.
+	 * With --remove the masked object is removed with vertical seams first, the target size only removes further seams.
+	 * @param image The 8UC3 image.
+	 * @param options The target size, energy mode and order.
+	 * @param source The image file, named in the log.
+	 * @return The carved image.
+	 * @throws std::invalid_argument if the target size needs as many seams as the image has pixels across them,
+	 * if it enlarges the image with --optimal-order, --pyramid, --protect or --remove, or if the transport map of --optimal-order
+	 * does not fit into the installed memory.
+	 */
+	cv::Mat carve(const cv::Mat& image, const Options& options, const fs::path& source)
+	{
+		const auto width = options.width > 0 ? options.width : image.cols;
+		const auto height = options.height > 0 ? options.height : image.rows;
+		if(std::abs(width - image.cols) >= image.cols || std::abs(height - image.rows) >= image.rows)
+			throw std::invalid_argument{"Target size " + std::to_string(width) + "x" + std::to_string(height) + " needs more seams than the image size "
+										+ std::to_string(image.cols) + "x" + std::to_string(image.rows) + " has"};
+
+		if(width > image.cols || height > image.rows)
+		{
+			if(options.optimal_order || options.pyramid > 0 || !options.protect.empty() || !options.remove.empty())
+				throw std::invalid_argument{"--optimal-order, --pyramid, --protect and --remove only shrink images"};
+
+			// The seams to insert are the first ones the orders would remove
+			const auto columns = cvutil::SeamOrder{image, image.cols - std::abs(width - image.cols), cvutil::Orientation::vertical, options.mode, options.energy};
+			const auto rows = cvutil::SeamOrder{image, image.rows - std::abs(height - image.rows), cvutil::Orientation::horizontal, options.mode, options.energy};
+			auto resized = cv::Mat{};
+			cvutil::retarget<cv::Vec3b>(image, columns, rows, cv::Size(width, height), resized);
+			return resized;
+		}
+
+		auto carver = cvutil::SeamCarver{image, options.mode, options.energy};
+		if(options.pyramid > 0)
+		{
+			// Sums the energy of every removed seam
+			auto carve_all = [&image, width, height] (cvutil::SeamCarver& carver) {
+				auto energy = 0LL;
+				for(const auto orientation : {cvutil::Orientation::vertical, cvutil::Orientation::horizontal})
+				{
+					const auto count = orientation == cvutil::Orientation::vertical ? image.cols - width : image.rows - height;
+					for(int s = 0; s < count; ++s)
+					{
+						carver.step(orientation);
+						energy += carver.cost(orientation);
+					}
+				}
+				return energy;
+			};
+
+			auto start = std::chrono::steady_clock::now();
+			carver.coarse_to_fine(options.pyramid, options.band);
+			const auto coarse = carve_all(carver);
+			const auto coarse_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			auto exact_carver = cvutil::SeamCarver{image, options.mode, options.energy};
+			const auto exact = carve_all(exact_carver);
+			const auto exact_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			log(std::cout, source.string() + ": pyramid energy " + std::to_string(coarse) + " ("
+				+ std::to_string(static_cast<int>(coarse_seconds * 1e3)) + " ms), exact energy " + std::to_string(exact) + " ("
+				+ std::to_string(static_cast<int>(exact_seconds * 1e3)) + " ms)");
+			return cvutil::gather<cv::Vec3b>(image, carver.index());
+		}
+
+		if(!options.protect.empty() || !options.remove.empty())
+		{
+			carver.set_masks(read_mask(options.protect, image.size()), read_mask(options.remove, image.size()));
+			if(!options.remove.empty())
+			{
+				const auto seams = carver.remove_object(cvutil::Orientation::vertical);
+				log(std::cout, source.string() + ": object removed with " + std::to_string(seams) + " seams, "
+					+ std::to_string(carver.remaining()) + " masked pixels left");
+			}
+		}
+
+		if(!options.optimal_order)
+		{
+			carver.carve(std::max(carver.size().width - width, 0), cvutil::Orientation::vertical);
+			carver.carve(std::max(carver.size().height - height, 0), cvutil::Orientation::horizontal);
+			return cvutil::gather<cv::Vec3b>(image, carver.index());
+		}
+
+		// Refused up front, the transport map keeps two anti-diagonals of carved images
+		const auto memory = cvutil::physical_memory();
+		const auto needed = cvutil::optimal_schedule_memory(image.size(), image.cols - width, image.rows - height, options.mode, options.energy);
+		if(memory > 0 && needed > memory)
+			throw std::invalid_argument{"--optimal-order needs about " + std::to_string(needed >> 20) + " MiB for " + std::to_string(image.cols - width)
+										+ " vertical and " + std::to_string(image.rows - height) + " horizontal seams, "
+										+ std::to_string(memory >> 20) + " MiB are installed"};
+
+		auto start = std::chrono::steady_clock::now();
+		const auto optimal = cvutil::optimal_schedule(image, image.cols - width, image.rows - height, options.mode, options.energy);
+		const auto optimal_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		const auto fixed = cvutil::fixed_schedule(image, image.cols - width, image.rows - height, options.mode, options.energy);
+		const auto fixed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// The transport map is greedy and can lose against the fixed order
+		const auto interleave = optimal.cost <= fixed.cost;
+		log(std::cout, source.string() + ": transport map order energy " + std::to_string(optimal.cost) + " ("
+			+ std::to_string(static_cast<int>(optimal_seconds * 1e3)) + " ms), fixed order energy " + std::to_string(fixed.cost) + " ("
+			+ std::to_string(static_cast<int>(fixed_seconds * 1e3)) + " ms), carving the " + (interleave ? "transport map" : "fixed") + " order");
+
+		for(const auto orientation : (interleave ? optimal : fixed).order)
+			carver.step(orientation);
+		return cvutil::gather<cv::Vec3b>(image, carver.index());
+	}
+
+	/**
+	 * @brief describe The progress line of a carved image.
+	 */
+	std::string describe(const fs::path& path, cv::Size before, cv::Size after, double seconds)
+	{
+		return path.string() + ": " + std::to_string(before.width) + "x" + std::to_string(before.height) + " -> "
+				+ std::to_string(after.width) + "x" + std::to_string(after.height) + " ("
+				+ std::to_string(static_cast<int>(seconds * 1e3)) + " ms)";
+	}
+
+	/**
+	 * @brief carve_file Carves a single image file.
+	 * @return The exit code.
+	 */
+	int carve_file(const Options& options)
+	{
+		const auto image = cv::imread(options.input.string(), cv::IMREAD_COLOR);
+		if(image.empty())
+		{
+			log(std::cerr, "ERROR: Cannot read " + options.input.string());
+			return 1;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto carved = carve(image, options, options.input);
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if(!cv::imwrite(options.output.string(), carved))
+		{
+			log(std::cerr, "ERROR: Cannot write " + options.output.string());
+			return 1;
+		}
+		log(std::cout, describe(options.input, image.size(), carved.size(), seconds));
+		return 0;
+	}
+
+	/**
+	 * @brief stream_file Carves a PPM file with bounded memory.
+	 * @return The exit code.
+	 */
+	int stream_file(const Options& options)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const auto report = cvutil::stream_carve(options.input.string(), options.output.string(), options.width,
+												 static_cast<size_t>(options.stream) << 20, options.mode);
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		log(std::cout, options.input.string() + ": width " + std::to_string(options.width) + " in strips of "
+			+ std::to_string(report.strip_rows) + " rows, " + std::to_string(report.memory >> 20) + " MiB ("
+			+ std::to_string(static_cast<int>(seconds * 1e3)) + " ms)");
+		return 0;
+	}
+
+	/**
+	 * @brief save_order Carves a single image file down to the minimum size and saves the seam order.
+	 * @return The exit code.
+	 */
+	int save_order(const Options& options)
+	{
+		const auto image = cv::imread(options.input.string(), cv::IMREAD_COLOR);
+		if(image.empty())
+		{
+			log(std::cerr, "ERROR: Cannot read " + options.input.string());
+			return 1;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto order = options.width > 0 ? cvutil::SeamOrder{image, options.width, cvutil::Orientation::vertical, options.mode, options.energy}
+											 : cvutil::SeamOrder{image, options.height, cvutil::Orientation::horizontal, options.mode, options.energy};
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		order.save(options.save_order);
+		log(std::cout, options.save_order + ": " + std::to_string(order.seams()) + " seams of "
+			+ std::to_string(image.cols) + "x" + std::to_string(image.rows) + " ("
+			+ std::to_string(static_cast<int>(seconds * 1e3)) + " ms), " + std::to_string(fs::file_size(options.save_order)) + " bytes");
+		return 0;
+	}
+
+	/**
+	 * @brief retarget_file Retargets a single image file with a saved seam order.
+	 * @return The exit code.
+	 */
+	int retarget_file(const Options& options)
+	{
+		const auto image = cv::imread(options.input.string(), cv::IMREAD_COLOR);
+		if(image.empty())
+		{
+			log(std::cerr, "ERROR: Cannot read " + options.input.string());
+			return 1;
+		}
+
+		const auto order = cvutil::SeamOrder::load(options.order);
+		const auto vertical = order.orientation() == cvutil::Orientation::vertical;
+		if(vertical != (options.width > 0))
+		{
+			log(std::cerr, std::string{"ERROR: The seam order retargets the "} + (vertical ? "width" : "height") + " only");
+			return 1;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto carved = order.retarget<cv::Vec3b>(image, vertical ? options.width : options.height);
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if(!cv::imwrite(options.output.string(), carved))
+		{
+			log(std::cerr, "ERROR: Cannot write " + options.output.string());
+			return 1;
+		}
+		log(std::cout, describe(options.input, image.size(), carved.size(), seconds));
+		return 0;
+	}
+
+	/**
+	 * @brief carve_directory Carves every image of a directory in a three stage pipeline.
+	 * A reader thread decodes, the calling thread carves with the thread pool and a writer thread encodes, so the
+	 * stages work on different files at the same time. Bounded queues between the stages limit the images in memory.
+	 * @return The exit code.
+	 */
+	int carve_directory(const Options& options)
+	{
+		auto files = std::vector<fs::path>{};
+		for(const auto& entry : fs::directory_iterator{options.input})
+			if(entry.is_regular_file() && is_image(entry.path()))
+				files.push_back(entry.path());
+		std::sort(files.begin(), files.end());
+
+		fs::create_directories(options.output);
+
+		auto decoded = cli::BoundedQueue<Job>{static_cast<size_t>(options.queue)};
+		auto carved = cli::BoundedQueue<Job>{static_cast<size_t>(options.queue)};
+		auto failures = std::atomic<int>{0};
+
+		auto reader = std::thread{[&] {
+			for(const auto& file : files)
+			{
+				auto job = Job{file, options.output / file.filename()};
+				try
+				{
+					job.image = cv::imread(file.string(), cv::IMREAD_COLOR);
+				}
+				catch(const std::exception& e)
+				{
+					log(std::cerr, "ERROR: " + file.string() + ": " + e.what());
+				}
+				if(job.image.empty())
+				{
+					log(std::cerr, "ERROR: Cannot read " + file.string());
+					++failures;
+					continue;
+				}
+				if(!decoded.push(std::move(job)))
+					break;
+			}
+			decoded.close();
+		}};
+
+		auto writer = std::thread{[&] {
+			while(auto job = carved.pop())
+			{
+				auto written = false;
+				try
+				{
+					written = cv::imwrite(job->target.string(), job->image);
+				}
+				catch(const std::exception& e)
+				{
+					log(std::cerr, "ERROR: " + job->target.string() + ": " + e.what());
+				}
+				if(!written)
+				{
+					log(std::cerr, "ERROR: Cannot write " + job->target.string());
+					++failures;
+				}
+			}
+		}};
+
+		while(auto job = decoded.pop())
+		{
+			try
+			{
+				const auto start = std::chrono::steady_clock::now();
+				const auto before = job->image.size();
+				job->image = carve(job->image, options, job->source);
+				job->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				log(std::cout, describe(job->source, before, job->image.size(), job->seconds));
+				carved.push(std::move(*job));
+			}
+			catch(const std::exception& e)
+			{
+				log(std::cerr, "ERROR: " + job->source.string() + ": " + e.what());
+				++failures;
+			}
+		}
+		carved.close();
+
+		reader.join();
+		writer.join();
+
+		log(std::cout, std::to_string(files.size() - static_cast<size_t>(failures.load())) + " of " + std::to_string(files.size()) + " images carved");
+		return failures > 0 ? 1 : 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2 || std::string{argv[1]} == "-h" || std::string{argv[1]} == "--help")
+	{
+		std::cout << usage;
+		return argc < 2 ? 1 : 0;
+	}
+
+	auto options = Options{};
+	try
+	{
+		options = parse(argc, argv);
+	}
+	catch(const std::invalid_argument& e)
+	{
+		std::cerr << "ERROR: " << e.what() << "\n\n" << usage;
+		return 1;
+	}
+
+	try
+	{
+		cvutil::set_thread_count(options.threads);
+
+		if(options.benchmark)
+		{
+			const auto image = cv::imread(options.input.string(), cv::IMREAD_COLOR);
+			if(image.empty())
+			{
+				log(std::cerr, "ERROR: Cannot read " + options.input.string());
+				return 1;
+			}
+			cli::run_benchmark(image, options.repeat);
+			return 0;
+		}
+
+		if(!options.save_order.empty())
+			return save_order(options);
+		if(!options.order.empty())
+			return retarget_file(options);
+		if(options.stream > 0)
+			return stream_file(options);
+		return fs::is_directory(options.input) ? carve_directory(options) : carve_file(options);
+	}
+	catch(const std::exception& e)
+	{
+		log(std::cerr, std::string{"ERROR: "} + e.what());
+		return 1;
+	}
+}
@@ -0,0 +1,22 @@
+# Links an application against the seam carving core library.
+# Include from a project one directory below the top level.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/debug
+else: CORE_LIB_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_LIB_DIR -lseamcarving
+
+win32-g++: PRE_TARGETDEPS += $$CORE_LIB_DIR/libseamcarving.a
+else:win32: PRE_TARGETDEPS += $$CORE_LIB_DIR/seamcarving.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libseamcarving.a
+
+unix {
+	LIBS +=	-lopencv_core \
+			-lopencv_imgproc \
+			-lopencv_imgcodecs \
+			-lpthread
+}
@@ -0,0 +1,46 @@
+#-------------------------------------------------
+#
+# Seam carving core: static library, depends only on OpenCV
+#
+#-------------------------------------------------
+
+CONFIG += c++1z staticlib
+
+QT -= core gui
+
+TARGET = seamcarving
+TEMPLATE = lib
+
+
+SOURCES += cv_utility.cpp \
+    thread_pool.cpp \
+    seam_finder.cpp \
+    energy_kernel.cpp \
+    seam_kernel.cpp \
+    seam_carver.cpp \
+    seam_order.cpp \
+    seam_schedule.cpp \
+    seam_pyramid.cpp \
+    seam_list.cpp \
+    energy_policy.cpp \
+    mapped_file.cpp \
+    stream_carver.cpp \
+    route_matrix.cpp
+
+HEADERS  += cv_utility.h \
+    thread_pool.h \
+    seam_finder.h \
+    energy_kernel.h \
+    seam_kernel.h \
+    seam_carver.h \
+    seam_order.h \
+    seam_schedule.h \
+    seam_pyramid.h \
+    seam_list.h \
+    energy_policy.h \
+    mapped_file.h \
+    stream_carver.h \
+    route_matrix.h \
+    tiled_rows.h \
+    seam_policy.h \
+    simd.h
@@ -0,0 +1,583 @@
+#include "cv_utility.h"
+
+#include "energy_kernel.h"
+#include "route_matrix.h"
+#include "seam_kernel.h"
+#include "thread_pool.h"
+#include "tiled_rows.h"
+
+#include <iostream>
+
+namespace
+{
+	/**
+	 * @brief sobel_energy Calculates the energy of one pixel exactly like cvutil::energy does.
+	 * @param image The one channel image.
+	 * @param row The row index.
+	 * @param col The column index.
+	 * @return The sum of absolute Sobel gradients, scaled to [0, max(uchar)].
+	 */
+	uchar sobel_energy(const cv::Mat& image, int row, int col)
+	{
+		return cvutil::kernel::sobel_pixel(image.ptr<uchar>(std::max(row-1, 0)), image.ptr<uchar>(row), image.ptr<uchar>(std::min(row+1, image.rows-1)), col, image.cols);
+	}
+
+	template<typename Compare, typename Cost>
+	/**
+	 * @brief find_vertical_seam The seam search behind all vertical_seam overloads.
+	 * @param image The 8UC1 energy map, or the grayscale image in forward mode.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 * @param mode What the cumulative energy measures.
+	 * @param mask The 8UC1 SeamMask labels of the image, or empty for no bias.
+	 * @return The column coordinate for each row.
+	 */
+	std::vector<int> find_vertical_seam(const cv::Mat& image, const Compare& compare, cvutil::EnergyMode mode = cvutil::EnergyMode::backward, const cv::Mat& mask = cv::Mat{})
+	{
+		if(image.type() != CV_8UC1)
+		{
+			std::cout << "ERROR: Image has more than one channel or a depth >8 bits. Seam finding not supported!" << std::endl;
+			throw std::invalid_argument{"Vertical seam finding applied to image with invalid type"};
+		}
+		if(image.cols <= 1)
+		{
+			std::cout << "ERROR: Image has only one or less columns. Seam finding not supported!" << std::endl;
+			throw std::invalid_argument{"Vertical seam finding applied to image with too few columns"};
+		}
+		if(!mask.empty() && (mask.type() != CV_8UC1 || mask.size() != image.size()))
+		{
+			std::cout << "ERROR: Mask does not match up with the image. Seam finding not supported!" << std::endl;
+			throw std::invalid_argument{"Vertical seam finding applied to mismatching image and mask"};
+		}
+
+		// Init
+		// Route matrix, 2 bits per cell. The kernels write byte offsets into one row per thread, every thread packs its block from there.
+		const auto cols = image.cols;
+		auto routes = cvutil::RouteMatrix{};
+		routes.create(image.rows, cols);
+
+		// The last row of every band of rows, read by all threads during the next band. Initialized with the first row of the image.
+		std::vector<Cost> edges[2] = {std::vector<Cost>(static_cast<size_t>(cols)), std::vector<Cost>(static_cast<size_t>(cols))};
+		const auto forward = mode == cvutil::EnergyMode::forward;
+		for(int c = 0; c < cols; ++c)
+			edges[0][static_cast<size_t>(c)] = static_cast<Cost>(forward ? cvutil::kernel::forward_top(image.ptr<uchar>(0), c, cols) : image.at<uchar>(0, c));
+		const auto masked = !mask.empty();
+		if(masked)
+			cvutil::kernel::bias_row(mask.ptr<uchar>(0), edges[0].data(), 0, cols, compare);
+
+		// Multithreading, one block of columns per thread and a barrier after every band of rows (see tiled_rows)
+		auto buffers = cvutil::TileBuffers<Cost>{};
+		const auto bands = cvutil::tiled_rows<Cost>(1, image.rows, cols, buffers, edges[0].data(),
+			[&edges] (int b, int) { return edges[(b+1) % 2].data(); },
+			[&image, &mask, &routes, &compare, forward, masked, cols] (const cvutil::TileRow<Cost>& tile) {
+				const auto r = tile.row;
+				if(forward)
+					cvutil::kernel::forward_row(tile.prev, image.ptr<uchar>(r-1), image.ptr<uchar>(r), tile.cur, tile.offsets, tile.begin, tile.finish, cols, compare);
+				else
+					cvutil::kernel::relax_row(tile.prev, image.ptr<uchar>(r), tile.cur, tile.offsets, tile.begin, tile.finish, cols, compare);
+				if(masked)
+					cvutil::kernel::bias_row(mask.ptr<uchar>(r), tile.cur, tile.begin, tile.finish, compare);
+				cvutil::pack_routes(tile.offsets, routes.ptr(r), tile.start, tile.end);
+			});
+		const auto& last = edges[static_cast<size_t>(bands % 2)];
+
+		auto seam = std::vector<int>{};
+		const auto col = static_cast<int>(std::max_element(last.begin(), last.end(), [&compare] (const Cost& a, const Cost& b) { return !compare(a,b); }) - last.begin());
+		routes.backtrack(col, seam);
+		return seam;
+	}
+
+	/**
+	 * @brief transpose_energy Checks an energy map for a horizontal seam search and transposes it.
+	 * Walking the image column by column jumps a whole row stride per step, the transposed image is walked row by row.
+	 * @param image The 8UC1 energy map.
+	 * @return The transposed energy map.
+	 */
+	cv::Mat transpose_energy(const cv::Mat& image)
+	{
+		if(image.type() != CV_8UC1)
+		{
+			std::cout << "ERROR: Image has more than one channel or a depth >8 bits. Seam finding not supported!" << std::endl;
+			throw std::invalid_argument{"Horizontal seam finding applied to image with invalid type"};
+		}
+		if(image.rows <= 1)
+		{
+			std::cout << "ERROR: Image has only one or less rows. Seam finding not supported!" << std::endl;
+			throw std::invalid_argument{"Horizontal seam finding applied to image with too few rows"};
+		}
+
+		auto transposed = cv::Mat{};
+		cvutil::transpose(image, transposed);
+		return transposed;
+	}
+
+	template<typename T>
+	/**
+	 * @brief transpose_blocked Transposes image into transposed in square blocks, one block of result rows per thread.
+	 * @param image The original image.
+	 * @param transposed The already allocated result.
+	 */
+	void transpose_blocked(const cv::Mat& image, cv::Mat& transposed)
+	{
+		// 32x32 pixels of up to 8 bytes fit into the L1 cache together with their transposed copy
+		constexpr int block = 32;
+
+		cvutil::thread_pool().parallel_for(0, (transposed.rows + block - 1) / block, [&image, &transposed] (int start, int end) {
+			for(int r0 = start * block; r0 < std::min(end * block, transposed.rows); r0 += block)
+			{
+				for(int c0 = 0; c0 < transposed.cols; c0 += block)
+				{
+					for(int r = r0; r < std::min(r0 + block, transposed.rows); ++r)
+					{
+						auto out = transposed.ptr<T>(r);
+						for(int c = c0; c < std::min(c0 + block, transposed.cols); ++c)
+							out[c] = image.ptr<T>(c)[r];
+					}
+				}
+			}
+		});
+	}
+
+	/**
+	 * @brief fused_gray_energy Converts an 8UC3 image to grayscale and computes the energy in the same pass.
+	 * Every thread walks its block of rows once: a gray row is computed right before the energy row below it needs it,
+	 * so it is read back from the L1 cache. Without a gray image only a ring of three gray rows per thread is kept.
+	 * @param image The 8UC3 image.
+	 * @param gray Receives the grayscale image if not nullptr.
+	 * @param energy Receives the energy map.
+	 */
+	void fused_gray_energy(const cv::Mat& image, cv::Mat* gray, cv::Mat& energy)
+	{
+		if(image.type() != CV_8UC3)
+		{
+			std::cout << "ERROR: Image is not 8UC3. Fused grayscale and energy not supported!" << std::endl;
+			throw std::invalid_argument{"Fused grayscale and energy applied to image with invalid type"};
+		}
+
+		const auto rows = image.rows;
+		const auto cols = image.cols;
+		if(gray != nullptr)
+			gray->create(image.size(), CV_8UC1);
+		energy.create(image.size(), CV_8UC1);
+
+		// Multithreading, one block of rows per thread. The rows above and below the block are converted by both neighbours.
+		cvutil::thread_pool().parallel_for(0, rows, [&image, gray, &energy, rows, cols] (int start, int end) {
+			if(start >= end)
+				return;
+
+			// Three consecutive rows always fall into different slots of the ring
+			auto ring = std::vector<uchar>(3 * static_cast<size_t>(cols));
+			auto row = [&ring, gray, start, end, cols] (int r) {
+				return gray != nullptr && r >= start && r < end ? gray->ptr<uchar>(r) : ring.data() + static_cast<size_t>(r % 3) * cols;
+			};
+			auto convert = [&image, &row, cols] (int r) { cvutil::kernel::gray_row(image.ptr<uchar>(r), row(r), cols); };
+
+			if(start > 0)
+				convert(start - 1);
+			convert(start);
+			for(int r = start; r < end; ++r)
+			{
+				// Clamping at the top and bottom border only selects the row pointers
+				const auto below = std::min(r+1, rows-1);
+				if(below > r)
+					convert(below);
+				cvutil::kernel::sobel_row(row(std::max(r-1, 0)), row(r), row(below), energy.ptr<uchar>(r), cols);
+			}
+		});
+	}
+
+	/**
+	 * @brief The RemainingColumns class Fenwick tree over the columns of a row that are still present,
+	 * finds the n-th remaining column in O(log(cols)).
+	 */
+	class RemainingColumns
+	{
+	public:
+		explicit RemainingColumns(int cols) :
+			cols{cols}, tree(static_cast<size_t>(cols) + 1)
+		{
+			while(top * 2 <= cols)
+				top *= 2;
+		}
+
+		/**
+		 * @brief reset Makes every column present again, in O(cols).
+		 */
+		void reset()
+		{
+			std::fill(tree.begin(), tree.end(), 1);
+			tree[0] = 0;
+			for(int i = 1; i <= cols; ++i)
+				if(i + (i & -i) <= cols)
+					tree[static_cast<size_t>(i + (i & -i))] += tree[static_cast<size_t>(i)];
+		}
+
+		/**
+		 * @brief take Removes the remaining column at a position.
+		 * @param position The position among the remaining columns.
+		 * @return The original column.
+		 */
+		int take(int position)
+		{
+			// Descend to the original column of the (position+1)-th remaining one
+			auto pos = 0;
+			auto remaining = position + 1;
+			for(int step = top; step > 0; step /= 2)
+			{
+				if(pos + step <= cols && tree[static_cast<size_t>(pos + step)] < remaining)
+				{
+					pos += step;
+					remaining -= tree[static_cast<size_t>(pos)];
+				}
+			}
+
+			for(int i = pos + 1; i <= cols; i += i & -i)
+				--tree[static_cast<size_t>(i)];
+			return pos;
+		}
+
+	private:
+		int cols;
+		int top{1};
+		std::vector<int> tree;
+	};
+}
+
+cv::Mat cvutil::grayscale(const cv::Mat& image)
+{
+	// Check for invalid images
+	if(image.depth() != CV_8U)
+	{
+		std::cout << "ERROR: Image does not have 8 bit depth. Grayscaling not supported!" << std::endl;
+		throw std::invalid_argument{"Grayscaling of image with invalid depth"};
+	}
+
+	switch(image.channels())
+	{
+	case 3:	// 3 channels <=> color
+	{
+		auto gray = cv::Mat(image.size(), CV_8UC1);
+
+		// Multithreading, one block of rows per thread
+		thread_pool().parallel_for(0, image.rows, [&image, &gray] (int start, int end) {
+			for(int r = start; r < end; ++r)
+				kernel::gray_row(image.ptr<uchar>(r), gray.ptr<uchar>(r), image.cols);
+		});
+
+		return gray;
+	}
+
+		// Check for invalid images
+	case 1:	// 1 channel <=> grayscale
+		std::cout << "WARNING: Image is already grayscale!" << std::endl;
+		return image.clone();
+
+	default:	// 2 or >3 channels, not supported
+		std::cout << "ERROR: Image has " << image.channels() << " channels. Grayscaling not supported!" << std::endl;
+		throw std::invalid_argument{"Grayscaling of image with invalid number of channels"};
+	}
+}
+
+cv::Mat cvutil::energy(const cv::Mat& image)
+{
+	// Check for invalid images
+	if(image.type() != CV_8UC1)
+	{
+		std::cout << "ERROR: Image has more than one channel or a depth >8 bits. Energy function not supported!" << std::endl;
+		throw std::invalid_argument{"Energy function applied to image with invalid type"};
+	}
+
+	auto energy = cv::Mat(image.size(), CV_8UC1);
+
+	// Multithreading, one block of rows per thread.
+	// Clamping at the top and bottom border only selects the row pointers, the kernel clamps the first and last column.
+	thread_pool().parallel_for(0, image.rows, [&image, &energy] (int start, int end) {
+		for(int r = start; r < end; ++r)
+			kernel::sobel_row(image.ptr<uchar>(std::max(r-1, 0)), image.ptr<uchar>(r), image.ptr<uchar>(std::min(r+1, image.rows-1)), energy.ptr<uchar>(r), image.cols);
+	});
+
+	return energy;
+}
+
+void cvutil::gray_energy(const cv::Mat& image, cv::Mat& gray, cv::Mat& energy)
+{
+	fused_gray_energy(image, &gray, energy);
+}
+
+cv::Mat cvutil::gray_energy(const cv::Mat& image)
+{
+	auto energy = cv::Mat{};
+	fused_gray_energy(image, nullptr, energy);
+	return energy;
+}
+
+void cvutil::update_vertical_energy(cv::Mat& energy, const cv::Mat& image, const std::vector<int>& seam)
+{
+	if(image.type() != CV_8UC1 || energy.type() != CV_8UC1)
+	{
+		std::cout << "ERROR: Image or energy has more than one channel or a depth >8 bits. Energy update not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical energy update applied to image with invalid type"};
+	}
+	if(energy.rows != image.rows || energy.cols != image.cols+1)
+	{
+		std::cout << "ERROR: Energy map does not match up with the carved image. Energy update not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical energy update applied to mismatching energy and image"};
+	}
+
+	remove_vertical_seam<uchar>(energy, seam);
+
+	// A pixel keeps its energy if its whole 3x3 neighbourhood lies on one side of the seam.
+	// Adjacent seam positions differ by at most one, so at most four pixels per row change.
+	for(int r = 0; r < image.rows; ++r)
+	{
+		const auto above = seam[static_cast<size_t>(std::max(r-1, 0))];
+		const auto here = seam[static_cast<size_t>(r)];
+		const auto below = seam[static_cast<size_t>(std::min(r+1, image.rows-1))];
+
+		const auto start = std::max(std::min({above, here, below}) - 1, 0);
+		const auto end = std::min(std::max({above, here, below}), image.cols-1);
+		for(int c = start; c <= end; ++c)
+			energy.at<uchar>(r, c) = sobel_energy(image, r, c);
+	}
+}
+
+void cvutil::update_horizontal_energy(cv::Mat& energy, const cv::Mat& image, const std::vector<int>& seam)
+{
+	if(image.type() != CV_8UC1 || energy.type() != CV_8UC1)
+	{
+		std::cout << "ERROR: Image or energy has more than one channel or a depth >8 bits. Energy update not supported!" << std::endl;
+		throw std::invalid_argument{"Horizontal energy update applied to image with invalid type"};
+	}
+	if(energy.cols != image.cols || energy.rows != image.rows+1)
+	{
+		std::cout << "ERROR: Energy map does not match up with the carved image. Energy update not supported!" << std::endl;
+		throw std::invalid_argument{"Horizontal energy update applied to mismatching energy and image"};
+	}
+
+	remove_horizontal_seam<uchar>(energy, seam);
+
+	// A pixel keeps its energy if its whole 3x3 neighbourhood lies on one side of the seam.
+	// Adjacent seam positions differ by at most one, so at most four pixels per column change.
+	for(int c = 0; c < image.cols; ++c)
+	{
+		const auto left = seam[static_cast<size_t>(std::max(c-1, 0))];
+		const auto here = seam[static_cast<size_t>(c)];
+		const auto right = seam[static_cast<size_t>(std::min(c+1, image.cols-1))];
+
+		const auto start = std::max(std::min({left, here, right}) - 1, 0);
+		const auto end = std::min(std::max({left, here, right}), image.rows-1);
+		for(int r = start; r <= end; ++r)
+			energy.at<uchar>(r, c) = sobel_energy(image, r, c);
+	}
+}
+
+template<typename Compare, typename Cost>
+std::vector<int> cvutil::vertical_seam(const cv::Mat& image)
+{
+	return find_vertical_seam<Compare, Cost>(image, Compare{});
+}
+
+std::vector<int> cvutil::vertical_seam(const cv::Mat& image, std::function<bool(int, int)> compare)
+{
+	// Comparisons that a policy covers run the specialized code
+	if(compare.target<std::less<int>>() != nullptr)
+		return vertical_seam<MinSeam>(image);
+	if(compare.target<std::greater<int>>() != nullptr)
+		return vertical_seam<MaxSeam>(image);
+	return find_vertical_seam<std::function<bool(int, int)>, int>(image, compare);
+}
+
+std::vector<int> cvutil::vertical_seam(const cv::Mat& image, EnergyMode mode)
+{
+	return find_vertical_seam<MinSeam, int>(image, MinSeam{}, mode);
+}
+
+std::vector<int> cvutil::vertical_seam(const cv::Mat& image, const cv::Mat& mask, EnergyMode mode)
+{
+	return find_vertical_seam<MinSeam, int>(image, MinSeam{}, mode, mask);
+}
+
+cv::Mat cvutil::index_map(cv::Size size)
+{
+	auto index = cv::Mat(size, CV_32SC2);
+	thread_pool().parallel_for(0, size.height, [&size, &index] (int start, int end) {
+		for(int r = start; r < end; ++r)
+		{
+			auto row = index.ptr<cv::Vec<int, 2>>(r);
+			for(int c = 0; c < size.width; ++c)
+				row[c] = cv::Vec<int, 2>(r, c);
+		}
+	});
+	return index;
+}
+
+std::vector<cv::Point> cvutil::original_seam(const cv::Mat& index, const std::vector<int>& seam)
+{
+	auto pixels = std::vector<cv::Point>{};
+	original_seam(index, seam, pixels);
+	return pixels;
+}
+
+void cvutil::original_seam(const cv::Mat& index, const std::vector<int>& seam, std::vector<cv::Point>& pixels)
+{
+	if(index.type() != CV_32SC2)
+	{
+		std::cout << "ERROR: Index map is not of type CV_32SC2. Seam projection not supported!" << std::endl;
+		throw std::invalid_argument{"Seam projection applied to invalid index map"};
+	}
+	if(index.rows != static_cast<int>(seam.size()))
+	{
+		std::cout << "ERROR: Seam size does not match up with index map height. Seam projection not supported!" << std::endl;
+		throw std::invalid_argument{"Seam projection applied to mismatching index map and seam"};
+	}
+
+	pixels.resize(seam.size());
+	for(int r = 0; r < index.rows; ++r)
+	{
+		const auto& original = index.at<cv::Vec<int, 2>>(r, seam[static_cast<size_t>(r)]);
+		pixels[static_cast<size_t>(r)] = cv::Point(original[1], original[0]);
+	}
+}
+
+cv::Mat cvutil::vertical_seam_mask(cv::Size size, const std::vector<std::vector<int>>& seams)
+{
+	for(const auto& seam : seams)
+	{
+		if(static_cast<int>(seam.size()) != size.height)
+		{
+			std::cout << "ERROR: Seam size does not match up with image height. Seam mask not supported!" << std::endl;
+			throw std::invalid_argument{"Vertical seam mask applied to mismatching image and seam"};
+		}
+	}
+
+	auto keep = cv::Mat(size, CV_8UC1, cv::Scalar::all(255));
+
+	// Multithreading, one block of rows per thread
+	thread_pool().parallel_for(0, size.height, [&size, &seams, &keep] (int start, int end) {
+		auto columns = RemainingColumns{size.width};
+		for(int r = start; r < end; ++r)
+		{
+			columns.reset();
+			auto mask = keep.ptr<uchar>(r);
+			for(const auto& seam : seams)
+				mask[columns.take(seam[static_cast<size_t>(r)])] = 0;
+		}
+	});
+	return keep;
+}
+
+cv::Mat cvutil::horizontal_seam_mask(cv::Size size, const std::vector<std::vector<int>>& seams)
+{
+	// Horizontal seams are vertical seams of the transposed image
+	auto keep = cv::Mat{};
+	cvutil::transpose(vertical_seam_mask(cv::Size(size.height, size.width), seams), keep);
+	return keep;
+}
+
+cv::Mat cvutil::vertical_seam_mask(cv::Size size, const SeamList& seams)
+{
+	for(const auto& seam : seams)
+	{
+		if(seam.size() != size.height)
+		{
+			std::cout << "ERROR: Seam size does not match up with image height. Seam mask not supported!" << std::endl;
+			throw std::invalid_argument{"Vertical seam mask applied to mismatching image and seam"};
+		}
+	}
+
+	auto keep = cv::Mat(size, CV_8UC1, cv::Scalar::all(255));
+
+	// Multithreading, one block of rows per thread. Every thread seeks each seam to its first row once,
+	// afterwards the seams are decoded one step per row.
+	thread_pool().parallel_for(0, size.height, [&size, &seams, &keep] (int start, int end) {
+		auto cursors = std::vector<SeamList::const_iterator>{};
+		cursors.reserve(seams.size());
+		for(const auto& seam : seams)
+			cursors.push_back(seam.seek(start));
+
+		auto columns = RemainingColumns{size.width};
+		for(int r = start; r < end; ++r)
+		{
+			columns.reset();
+			auto mask = keep.ptr<uchar>(r);
+			for(auto& cursor : cursors)
+			{
+				mask[columns.take(*cursor)] = 0;
+				++cursor;
+			}
+		}
+	});
+	return keep;
+}
+
+cv::Mat cvutil::horizontal_seam_mask(cv::Size size, const SeamList& seams)
+{
+	auto keep = cv::Mat{};
+	cvutil::transpose(vertical_seam_mask(cv::Size(size.height, size.width), seams), keep);
+	return keep;
+}
+
+template<typename Compare, typename Cost>
+std::vector<int> cvutil::horizontal_seam(const cv::Mat& image)
+{
+	return vertical_seam<Compare, Cost>(transpose_energy(image));
+}
+
+std::vector<int> cvutil::horizontal_seam(const cv::Mat& image, std::function<bool(int, int)> compare)
+{
+	return vertical_seam(transpose_energy(image), std::move(compare));
+}
+
+std::vector<int> cvutil::horizontal_seam(const cv::Mat& image, EnergyMode mode)
+{
+	return vertical_seam(transpose_energy(image), mode);
+}
+
+std::vector<int> cvutil::horizontal_seam(const cv::Mat& image, const cv::Mat& mask, EnergyMode mode)
+{
+	auto transposed = cv::Mat{};
+	if(!mask.empty())
+		cvutil::transpose(mask, transposed);
+	return vertical_seam(transpose_energy(image), transposed, mode);
+}
+
+void cvutil::transpose(const cv::Mat& image, cv::Mat& transposed)
+{
+	transposed.create(image.cols, image.rows, image.type());
+
+	switch(image.elemSize())
+	{
+	case 1:
+		transpose_blocked<uchar>(image, transposed);
+		break;
+	case 2:
+		transpose_blocked<ushort>(image, transposed);
+		break;
+	case 3:
+		transpose_blocked<cv::Vec<uchar, 3>>(image, transposed);
+		break;
+	case 4:
+		transpose_blocked<int>(image, transposed);
+		break;
+	case 8:
+		transpose_blocked<cv::Vec<int, 2>>(image, transposed);
+		break;
+	default:
+		std::cout << "ERROR: Image has " << image.elemSize() << " bytes per pixel. Transposing not supported!" << std::endl;
+		throw std::invalid_argument{"Transposing of image with invalid pixel size"};
+	}
+}
+
+// The compile-time specialized seam searches
+template std::vector<int> cvutil::vertical_seam<cvutil::MinSeam, uint16_t>(const cv::Mat&);
+template std::vector<int> cvutil::vertical_seam<cvutil::MinSeam, int>(const cv::Mat&);
+template std::vector<int> cvutil::vertical_seam<cvutil::MinSeam, float>(const cv::Mat&);
+template std::vector<int> cvutil::vertical_seam<cvutil::MaxSeam, uint16_t>(const cv::Mat&);
+template std::vector<int> cvutil::vertical_seam<cvutil::MaxSeam, int>(const cv::Mat&);
+template std::vector<int> cvutil::vertical_seam<cvutil::MaxSeam, float>(const cv::Mat&);
+
+template std::vector<int> cvutil::horizontal_seam<cvutil::MinSeam, uint16_t>(const cv::Mat&);
+template std::vector<int> cvutil::horizontal_seam<cvutil::MinSeam, int>(const cv::Mat&);
+template std::vector<int> cvutil::horizontal_seam<cvutil::MinSeam, float>(const cv::Mat&);
+template std::vector<int> cvutil::horizontal_seam<cvutil::MaxSeam, uint16_t>(const cv::Mat&);
+template std::vector<int> cvutil::horizontal_seam<cvutil::MaxSeam, int>(const cv::Mat&);
+template std::vector<int> cvutil::horizontal_seam<cvutil::MaxSeam, float>(const cv::Mat&);
@@ -0,0 +1,450 @@
+#ifndef CV_UTILITY_H
+#define CV_UTILITY_H
+
+#include "opencv2/core/core.hpp"
+#include "seam_list.h"
+#include "seam_policy.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <iostream>
+#include <type_traits>
+
+namespace cvutil
+{
+	/**
+	 * @brief grayscale Converts 8UC3 images to 8UC1 by averaging the channels per pixel.
+	 * @param image The original 8UC3 image.
+	 * @return The averaged 8UC1 image.
+	 */
+	cv::Mat grayscale(const cv::Mat& image);
+
+	/**
+	 * @brief energy Converts a single channel image to the result of its energy function per pixel.
+	 * To achieve this, a sobel edge detection is applied to the original and the gradient lengths are in a new image of the same type.
+	 * @param image The original one channel image.
+	 * @return The new image of equal type containing the gradient lengths.
+	 */
+	cv::Mat energy(const cv::Mat& image);
+
+	/**
+	 * @brief gray_energy Computes grayscale(image) and energy() of it in one pass over the rows, without reading the gray image back from memory.
+	 * @param image The original 8UC3 image.
+	 * @param gray Receives the grayscale image, identical to grayscale(image).
+	 * @param energy Receives the energy map, identical to energy(grayscale(image)).
+	 */
+	void gray_energy(const cv::Mat& image, cv::Mat& gray, cv::Mat& energy);
+
+	/**
+	 * @brief gray_energy Computes energy(grayscale(image)) in one pass, the gray image is never stored as a whole.
+	 * @param image The original 8UC3 image.
+	 * @return The energy map.
+	 */
+	cv::Mat gray_energy(const cv::Mat& image);
+
+	/**
+	 * @brief update_vertical_energy Updates an energy map after a vertical seam was removed from its image.
+	 * The seam is removed from the map like remove_vertical_seam does and only the pixels whose neighbourhood contained the seam are recomputed.
+	 * The result is identical to energy(image), but costs O(rows) instead of O(rows*cols) Sobel evaluations.
+	 * @param energy The energy map of the image before the seam was removed. Is modified.
+	 * @param image The one channel image after the seam was removed.
+	 * @param seam The removed seam. seam.size() == image.rows
+	 */
+	void update_vertical_energy(cv::Mat& energy, const cv::Mat& image, const std::vector<int>& seam);
+
+	/**
+	 * @brief update_horizontal_energy Updates an energy map after a horizontal seam was removed from its image.
+	 * The seam is removed from the map like remove_horizontal_seam does and only the pixels whose neighbourhood contained the seam are recomputed.
+	 * The result is identical to energy(image), but costs O(cols) instead of O(rows*cols) Sobel evaluations.
+	 * @param energy The energy map of the image before the seam was removed. Is modified.
+	 * @param image The one channel image after the seam was removed.
+	 * @param seam The removed seam. seam.size() == image.cols
+	 */
+	void update_horizontal_energy(cv::Mat& energy, const cv::Mat& image, const std::vector<int>& seam);
+
+	template<typename Compare, typename Cost = int>
+	/**
+	 * @brief vertical_seam Finds the vertical seam with a comparison policy and cumulative energy type fixed at compile time.
+	 * The comparison is inlined into the relax loop instead of being called through std::function twice per cell.
+	 * Instantiated for MinSeam and MaxSeam (see seam_policy.h) with uint16_t, int and float costs.
+	 * MinSeam with int costs runs the SIMD row kernel.
+	 * @param image The 8UC1 energy map.
+	 * @return The column coordinate for each row.
+	 */
+	std::vector<int> vertical_seam(const cv::Mat& image);
+
+	/**
+	 * @brief vertical_seam Finds the vertical seam with a comparison chosen at runtime.
+	 * std::less<int> and std::greater<int> are forwarded to vertical_seam<MinSeam> and vertical_seam<MaxSeam>,
+	 * any other comparison runs the generic loop.
+	 * @param image The 8UC1 energy map.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 * @return The column coordinate for each row.
+	 */
+	std::vector<int> vertical_seam(const cv::Mat& image, std::function<bool(int, int)> compare = std::less<int>());
+
+	/**
+	 * @brief vertical_seam Finds the vertical seam with minimal backward or forward energy.
+	 * Backward energy is the same search as vertical_seam<MinSeam>(image) on an energy map. Forward energy searches the
+	 * grayscale image itself and sums the gradients of the edges that the removal creates (see kernel::forward_row),
+	 * which avoids seams that leave new artefacts behind. Both run the SIMD row kernels.
+	 * @param image The 8UC1 energy map (backward) or grayscale image (forward).
+	 * @param mode What the cumulative energy measures.
+	 * @return The column coordinate for each row.
+	 */
+	std::vector<int> vertical_seam(const cv::Mat& image, EnergyMode mode);
+
+	/**
+	 * @brief vertical_seam Finds the vertical seam with minimal backward or forward energy, biased by a mask.
+	 * Seams avoid protected pixels and take pixels to remove (see SeamMask). The bias is added to every row of the
+	 * cumulative energy right after it is computed (see kernel::bias_row), blocks without labels are skipped.
+	 * @param image The 8UC1 energy map (backward) or grayscale image (forward).
+	 * @param mask The 8UC1 SeamMask labels of the image, or empty for no bias.
+	 * @param mode What the cumulative energy measures.
+	 * @return The column coordinate for each row.
+	 */
+	std::vector<int> vertical_seam(const cv::Mat& image, const cv::Mat& mask, EnergyMode mode = EnergyMode::backward);
+
+	template<typename Compare, typename Cost = int>
+	/**
+	 * @brief horizontal_seam Like horizontal_seam(image, compare) with a comparison policy and cost type fixed at compile time.
+	 * Instantiated like vertical_seam<Compare, Cost>.
+	 * @param image The 8UC1 energy map.
+	 * @return The row coordinate for each column.
+	 */
+	std::vector<int> horizontal_seam(const cv::Mat& image);
+
+	/**
+	 * @brief horizontal_seam Finds the horizontal seam as the vertical seam of the transposed image, so the DP runs on rows.
+	 * Callers that search many seams should keep a transposed working copy and use vertical_seam on it directly.
+	 * @param image The 8UC1 energy map.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 * @return The row coordinate for each column.
+	 */
+	std::vector<int> horizontal_seam(const cv::Mat& image, std::function<bool(int, int)> compare = std::less<int>());
+
+	/**
+	 * @brief horizontal_seam Finds the horizontal seam with minimal backward or forward energy, see vertical_seam(image, mode).
+	 * @param image The 8UC1 energy map (backward) or grayscale image (forward).
+	 * @param mode What the cumulative energy measures.
+	 * @return The row coordinate for each column.
+	 */
+	std::vector<int> horizontal_seam(const cv::Mat& image, EnergyMode mode);
+
+	/**
+	 * @brief horizontal_seam Finds the horizontal seam with minimal backward or forward energy, biased by a mask, see vertical_seam(image, mask, mode).
+	 * @param image The 8UC1 energy map (backward) or grayscale image (forward).
+	 * @param mask The 8UC1 SeamMask labels of the image, or empty for no bias.
+	 * @param mode What the cumulative energy measures.
+	 * @return The row coordinate for each column.
+	 */
+	std::vector<int> horizontal_seam(const cv::Mat& image, const cv::Mat& mask, EnergyMode mode = EnergyMode::backward);
+
+	/**
+	 * @brief transpose Transposes an image in cache sized blocks, so neither the reads nor the writes walk a whole column at once.
+	 * @param image The original image with 1, 2, 3, 4 or 8 bytes per pixel.
+	 * @param transposed Receives the transposed image. Is reallocated if its size or type does not fit, must not share data with image.
+	 */
+	void transpose(const cv::Mat& image, cv::Mat& transposed);
+
+	/**
+	 * @brief index_map Creates a map of original pixel coordinates.
+	 * Remove every seam from the map together with the image (e.g. remove_vertical_seam<cv::Vec2i>), then each element still holds the
+	 * original (row, col) of the pixel at its position, also across transposes.
+	 * @param size The size of the original image.
+	 * @return CV_32SC2 map with element (r, c) == (r, c).
+	 */
+	cv::Mat index_map(cv::Size size);
+
+	/**
+	 * @brief original_seam Projects a vertical seam of a carved image back to the original image in O(seam.size()).
+	 * For a horizontal seam, pass the transposed index map that was carved along with the transposed image.
+	 * @param index The index map in the state before the seam was removed.
+	 * @param seam The vector that contains the column coordinate for each row of index. seam.size() == index.rows
+	 * @return The original pixel position (x = column, y = row) of each seam pixel.
+	 */
+	std::vector<cv::Point> original_seam(const cv::Mat& index, const std::vector<int>& seam);
+
+	/**
+	 * @brief original_seam Like original_seam(index, seam), but writes into an existing vector to avoid allocations.
+	 * @param index The index map in the state before the seam was removed.
+	 * @param seam The vector that contains the column coordinate for each row of index. seam.size() == index.rows
+	 * @param pixels Receives the original pixel position (x = column, y = row) of each seam pixel.
+	 */
+	void original_seam(const cv::Mat& index, const std::vector<int>& seam, std::vector<cv::Point>& pixels);
+
+	template<typename T>
+	/**
+	 * @brief remove_vertical_seam Removes one pixel per row by moving all pixels after that one to the left and reducing the matrix header by one column.
+	 * @param image The image that is modified.
+	 * @param seam The vector that contains the column coordinate for each row. seam.size() == image.rows
+	 */
+	void remove_vertical_seam(cv::Mat& image, const std::vector<int>& seam)
+	{
+		if(image.rows != static_cast<int>(seam.size()))
+		{
+			std::cout << "ERROR: Seam size does not match up with image width. Seam removal not supported!" << std::endl;
+			throw std::invalid_argument{"Vertical seam removal applied to mismatching image and seam"};
+		}
+
+		for(int r = 0; r < image.rows; ++r)
+		{
+			auto row = image.ptr<T>(r);
+			std::copy(row + seam[static_cast<size_t>(r)]+1, row + image.cols, row + seam[static_cast<size_t>(r)]);
+		}
+
+		image = image(cv::Range(0, image.rows), cv::Range(0, image.cols-1));
+	}
+
+	template<typename T>
+	/**
+	 * @brief remove_horizontal_seam Removes one pixel per column by moving all pixels after that one upwards and reducing the matrix header by one row.
+	 * @param image The image that is modified.
+	 * @param seam The vector that contains the row coordinate for each column. seam.size() == image.cols
+	 */
+	void remove_horizontal_seam(cv::Mat& image, const std::vector<int>& seam)
+	{
+		if(image.cols != static_cast<int>(seam.size()))
+		{
+			std::cout << "ERROR: Seam size does not match up with image height. Seam removal not supported!" << std::endl;
+			throw std::invalid_argument{"Horizontal seam removal applied to mismatching image and seam"};
+		}
+
+		for(int c = 0; c < image.cols; ++c)
+			for(int r = seam[static_cast<size_t>(c)]+1; r < image.rows; ++r)
+				image.at<T>(r-1, c) = image.at<T>(r, c);
+
+		image = image(cv::Range(0, image.rows-1), cv::Range(0, image.cols));
+	}
+
+	/**
+	 * @brief vertical_seam_mask Marks the original pixels of a sequence of vertical seams.
+	 * Each row is resolved with an order statistic tree, so the cost is O(rows * (cols + seams * log(cols))).
+	 * @param size The size of the image before the first seam was removed.
+	 * @param seams The seams in removal order, each one in the coordinates of the image after the previous removals.
+	 * @return 8UC1 mask of the given size, 0 for removed and 255 for kept pixels.
+	 */
+	cv::Mat vertical_seam_mask(cv::Size size, const std::vector<std::vector<int>>& seams);
+
+	/**
+	 * @brief horizontal_seam_mask Marks the original pixels of a sequence of horizontal seams.
+	 * @param size The size of the image before the first seam was removed.
+	 * @param seams The seams in removal order, each one in the coordinates of the image after the previous removals.
+	 * @return 8UC1 mask of the given size, 0 for removed and 255 for kept pixels.
+	 */
+	cv::Mat horizontal_seam_mask(cv::Size size, const std::vector<std::vector<int>>& seams);
+
+	/**
+	 * @brief vertical_seam_mask Marks the original pixels of a sequence of delta encoded vertical seams.
+	 * The seams are decoded on the fly, one step per row and seam.
+	 */
+	cv::Mat vertical_seam_mask(cv::Size size, const SeamList& seams);
+
+	/**
+	 * @brief horizontal_seam_mask Marks the original pixels of a sequence of delta encoded horizontal seams.
+	 */
+	cv::Mat horizontal_seam_mask(cv::Size size, const SeamList& seams);
+
+	template<typename T, typename Seams = std::vector<std::vector<int>>>
+	/**
+	 * @brief remove_vertical_seams Removes a whole sequence of vertical seams in one streaming pass.
+	 * Equivalent to calling remove_vertical_seam for every seam, but every pixel is copied at most once.
+	 * @param image The original image, it is not modified.
+	 * @param seams The seams in removal order, as returned by consecutive seam searches.
+	 * A std::vector<std::vector<int>> or a SeamList.
+	 * @return The carved image with image.cols - seams.size() columns.
+	 */
+	cv::Mat remove_vertical_seams(const cv::Mat& image, const Seams& seams)
+	{
+		if(static_cast<int>(seams.size()) >= image.cols)
+		{
+			std::cout << "ERROR: More seams than columns. Seam removal not supported!" << std::endl;
+			throw std::invalid_argument{"Vertical seam removal applied to too many seams"};
+		}
+
+		const cv::Mat keep = vertical_seam_mask(image.size(), seams);
+		auto carved = cv::Mat(image.rows, image.cols - static_cast<int>(seams.size()), image.type());
+
+		// Multithreading, one block of rows per thread
+		thread_pool().parallel_for(0, image.rows, [&image, &keep, &carved] (int start, int end) {
+			for(int r = start; r < end; ++r)
+			{
+				const auto in = image.ptr<T>(r);
+				const auto mask = keep.ptr<uchar>(r);
+				auto out = carved.ptr<T>(r);
+
+				// Copy runs of kept pixels
+				for(int c = 0; c < image.cols;)
+				{
+					while(c < image.cols && !mask[c])
+						++c;
+					const auto run = c;
+					while(c < image.cols && mask[c])
+						++c;
+					out = std::copy(in + run, in + c, out);
+				}
+			}
+		});
+		return carved;
+	}
+
+	template<typename T, typename Seams = std::vector<std::vector<int>>>
+	/**
+	 * @brief remove_horizontal_seams Removes a whole sequence of horizontal seams in one streaming pass.
+	 * Equivalent to calling remove_horizontal_seam for every seam, but every pixel is copied at most once and the image is read row by row.
+	 * @param image The original image, it is not modified.
+	 * @param seams The seams in removal order, as returned by consecutive seam searches.
+	 * A std::vector<std::vector<int>> or a SeamList.
+	 * @return The carved image with image.rows - seams.size() rows.
+	 */
+	cv::Mat remove_horizontal_seams(const cv::Mat& image, const Seams& seams)
+	{
+		if(static_cast<int>(seams.size()) >= image.rows)
+		{
+			std::cout << "ERROR: More seams than rows. Seam removal not supported!" << std::endl;
+			throw std::invalid_argument{"Horizontal seam removal applied to too many seams"};
+		}
+
+		const cv::Mat keep = horizontal_seam_mask(image.size(), seams);
+		auto carved = cv::Mat(image.rows - static_cast<int>(seams.size()), image.cols, image.type());
+
+		// Multithreading, one block of columns per thread. Every column moves its kept pixels up to the next free row.
+		thread_pool().parallel_for(0, image.cols, [&image, &keep, &carved] (int start, int end) {
+			auto next = std::vector<int>(static_cast<size_t>(end - start), 0);
+			for(int r = 0; r < image.rows; ++r)
+			{
+				const auto in = image.ptr<T>(r);
+				const auto mask = keep.ptr<uchar>(r);
+				for(int c = start; c < end; ++c)
+					if(mask[c])
+						carved.ptr<T>(next[static_cast<size_t>(c - start)]++)[c] = in[c];
+			}
+		});
+		return carved;
+	}
+
+	template<typename T>
+	/**
+	 * @brief gather Builds the carved image from the original image and a carved index map in one pass.
+	 * Every output pixel is read once from its original position, whatever seams of either orientation were removed.
+	 * @param image The original image, it is not modified.
+	 * @param index The index map (see index_map) that was carved along with the image, in image orientation.
+	 * @return The carved image with the size of index.
+	 * @throws std::invalid_argument if the index map is not CV_32SC2, is larger than the image or points outside of it.
+	 */
+	cv::Mat gather(const cv::Mat& image, const cv::Mat& index)
+	{
+		if(index.type() != CV_32SC2 || index.rows > image.rows || index.cols > image.cols)
+		{
+			std::cout << "ERROR: Index map does not belong to the image. Gather not supported!" << std::endl;
+			throw std::invalid_argument{"Gather applied to an index map of a different image"};
+		}
+
+		auto carved = cv::Mat(index.size(), image.type());
+
+		// Multithreading, one block of rows per thread. Coordinates outside of the image are skipped and reported afterwards
+		auto outside = std::atomic<bool>{false};
+		thread_pool().parallel_for(0, index.rows, [&image, &index, &carved, &outside] (int start, int end) {
+			for(int r = start; r < end; ++r)
+			{
+				const auto origin = index.ptr<cv::Vec2i>(r);
+				auto out = carved.ptr<T>(r);
+				for(int c = 0; c < index.cols; ++c)
+				{
+					if(static_cast<unsigned>(origin[c][0]) >= static_cast<unsigned>(image.rows)
+					   || static_cast<unsigned>(origin[c][1]) >= static_cast<unsigned>(image.cols))
+					{
+						outside = true;
+						continue;
+					}
+					out[c] = image.ptr<T>(origin[c][0])[origin[c][1]];
+				}
+			}
+		});
+		if(outside)
+		{
+			std::cout << "ERROR: Index map points outside of the image. Gather not supported!" << std::endl;
+			throw std::invalid_argument{"Gather applied to an index map of a larger image"};
+		}
+		return carved;
+	}
+
+	template<typename T>
+	/**
+	 * @brief average The pixel that seam insertion puts between two neighbours, rounded per channel.
+	 * @param a One neighbour, an arithmetic value or a cv::Vec.
+	 * @param b The other neighbour.
+	 * @return The channel-wise mean of a and b.
+	 */
+	T average(const T& a, const T& b)
+	{
+		if constexpr(std::is_integral_v<T>)
+			return static_cast<T>((a + b + 1) / 2);
+		else if constexpr(std::is_floating_point_v<T>)
+			return static_cast<T>((a + b) / 2);
+		else
+		{
+			auto mean = T{};
+			for(int i = 0; i < T::channels; ++i)
+				mean[i] = average(a[i], b[i]);
+			return mean;
+		}
+	}
+
+	template<typename T>
+	/**
+	 * @brief clamp_at Mat::at(i0, i1) but with edge-clamped out-of-range coordinates.
+	 * @param image The image that is accessed.
+	 * @param row The row index.
+	 * @param col The column index.
+	 * @return The element at image[cow, col]
+	 */
+	const T& clamp_at(const cv::Mat& image, int row, int col)
+	{
+		auto size = image.size();
+		row = std::clamp(row, 0, size.height-1);
+		col = std::clamp(col, 0, size.width-1);
+		return image.at<T>(row, col);
+	}
+
+	template<typename T>
+	/**
+	 * @brief mirror_at Mat::at(i0, i1) but with edge-mirrored out-of-range coordinates.
+	 * @param image The image that is accessed.
+	 * @param row The row index.
+	 * @param col The column index.
+	 * @return The element at image[cow, col]
+	 */
+	const T& mirror_at(const cv::Mat& image, int row, int col)
+	{
+		auto size = image.size();
+		if(row < 0)
+			row = (std::abs(row) % size.height) - 1;
+		if(row >= size.height)
+			row = size.height - (row % size.height) - 1;
+
+		if(col < 0)
+			col = (std::abs(col) % size.width) - 1;
+		if(col >= size.width)
+			col = size.width - (col % size.width) - 1;
+
+		return image.at<T>(row, col);
+	}
+
+	template<typename T>
+	/**
+	 * @brief repeat_at Mat::at(i0, i1) but with repeated out-of-range coordinates.
+	 * @param image The image that is accessed.
+	 * @param row The row index.
+	 * @param col The column index.
+	 * @return The element at image[cow, col]
+	 */
+	const T& repeat_at(const cv::Mat& image, int row, int col)
+	{
+		auto size = image.size();
+		row = (row+size.height) % size.height;
+		col = (col+size.width) % size.width;
+		return image.at<T>(row, col);
+	}
+}
+
+#endif // CV_UTILITY_H
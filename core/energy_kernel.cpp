@@ -0,0 +1,437 @@
+#include "energy_kernel.h"
+
+#include "simd.h"
+
+namespace
+{
+	// (sum * 10923) >> 16 == sum / 6 for every possible sum of absolute gradients [0, 1530]
+	constexpr short div6_multiplier = 10923;
+
+	// (x * 21846) >> 16 == x / 3 for every value of a channel [0, 255]
+	constexpr short div3_multiplier = 21846;
+
+	using InteriorFunction = void (*)(const uchar*, const uchar*, const uchar*, uchar*, int, int);
+	using GrayFunction = void (*)(const uchar*, uchar*, int);
+	using TermsFunction = void (*)(const uchar* const*, int, const int*, int*, int);
+
+	/**
+	 * @brief interior_scalar Energy of the columns [begin, end), which must not touch the border.
+	 */
+	void interior_scalar(const uchar* above, const uchar* row, const uchar* below, uchar* out, int begin, int end)
+	{
+		for(int c = begin; c < end; ++c)
+		{
+			const int grad_h = (above[c+1] + row[c+1] + below[c+1]) - (above[c-1] + row[c-1] + below[c-1]);
+			const int grad_v = (below[c-1] + below[c] + below[c+1]) - (above[c-1] + above[c] + above[c+1]);
+			out[c] = static_cast<uchar>((std::abs(grad_h) + std::abs(grad_v))/6);
+		}
+	}
+
+#ifdef CVUTIL_SSE2
+	/**
+	 * @brief gradient8_sse2 Sum of absolute Sobel gradients of 8 pixels, given the 16 bit widened taps.
+	 */
+	inline __m128i gradient8_sse2(__m128i al, __m128i am, __m128i ar, __m128i rl, __m128i rr, __m128i bl, __m128i bm, __m128i br)
+	{
+		const auto zero = _mm_setzero_si128();
+		// Separable sums: column sums left and right, row sums above and below
+		const auto grad_h = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(ar, rr), br), _mm_add_epi16(_mm_add_epi16(al, rl), bl));
+		const auto grad_v = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(bl, bm), br), _mm_add_epi16(_mm_add_epi16(al, am), ar));
+		return _mm_add_epi16(_mm_max_epi16(grad_h, _mm_sub_epi16(zero, grad_h)), _mm_max_epi16(grad_v, _mm_sub_epi16(zero, grad_v)));
+	}
+
+	/**
+	 * @brief sobel8_sse2 Energy of 8 pixels, given the 16 bit widened taps.
+	 */
+	inline __m128i sobel8_sse2(__m128i al, __m128i am, __m128i ar, __m128i rl, __m128i rr, __m128i bl, __m128i bm, __m128i br)
+	{
+		return _mm_mulhi_epu16(gradient8_sse2(al, am, ar, rl, rr, bl, bm, br), _mm_set1_epi16(div6_multiplier));
+	}
+
+	void interior_sse2(const uchar* above, const uchar* row, const uchar* below, uchar* out, int begin, int end)
+	{
+		const auto zero = _mm_setzero_si128();
+		auto load = [] (const uchar* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			const auto al = load(above + c - 1), am = load(above + c), ar = load(above + c + 1);
+			const auto rl = load(row + c - 1), rr = load(row + c + 1);
+			const auto bl = load(below + c - 1), bm = load(below + c), br = load(below + c + 1);
+
+			const auto lo = sobel8_sse2(_mm_unpacklo_epi8(al, zero), _mm_unpacklo_epi8(am, zero), _mm_unpacklo_epi8(ar, zero),
+										_mm_unpacklo_epi8(rl, zero), _mm_unpacklo_epi8(rr, zero),
+										_mm_unpacklo_epi8(bl, zero), _mm_unpacklo_epi8(bm, zero), _mm_unpacklo_epi8(br, zero));
+			const auto hi = sobel8_sse2(_mm_unpackhi_epi8(al, zero), _mm_unpackhi_epi8(am, zero), _mm_unpackhi_epi8(ar, zero),
+										_mm_unpackhi_epi8(rl, zero), _mm_unpackhi_epi8(rr, zero),
+										_mm_unpackhi_epi8(bl, zero), _mm_unpackhi_epi8(bm, zero), _mm_unpackhi_epi8(br, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + c), _mm_packus_epi16(lo, hi));
+		}
+		interior_scalar(above, row, below, out, c, end);
+	}
+#endif
+
+#ifdef CVUTIL_AVX2
+	CVUTIL_TARGET_AVX2
+	inline __m256i load16_avx2(const uchar* p)
+	{
+		return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+	}
+
+	CVUTIL_TARGET_AVX2
+	void interior_avx2(const uchar* above, const uchar* row, const uchar* below, uchar* out, int begin, int end)
+	{
+		const auto multiplier = _mm256_set1_epi16(div6_multiplier);
+		auto& load = load16_avx2;
+
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			const auto al = load(above + c - 1), am = load(above + c), ar = load(above + c + 1);
+			const auto rl = load(row + c - 1), rr = load(row + c + 1);
+			const auto bl = load(below + c - 1), bm = load(below + c), br = load(below + c + 1);
+
+			// Separable sums: column sums left and right, row sums above and below
+			const auto grad_h = _mm256_sub_epi16(_mm256_add_epi16(_mm256_add_epi16(ar, rr), br), _mm256_add_epi16(_mm256_add_epi16(al, rl), bl));
+			const auto grad_v = _mm256_sub_epi16(_mm256_add_epi16(_mm256_add_epi16(bl, bm), br), _mm256_add_epi16(_mm256_add_epi16(al, am), ar));
+			const auto sum = _mm256_add_epi16(_mm256_abs_epi16(grad_h), _mm256_abs_epi16(grad_v));
+			const auto result = _mm256_mulhi_epu16(sum, multiplier);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + c), _mm_packus_epi16(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1)));
+		}
+		interior_scalar(above, row, below, out, c, end);
+	}
+#endif
+
+	/**
+	 * @brief gray_scalar Gray values of the pixels [begin, end).
+	 */
+	void gray_scalar(const uchar* pixels, uchar* gray, int begin, int end)
+	{
+		for(int c = begin; c < end; ++c)
+			gray[c] = static_cast<uchar>(pixels[3*c] / 3 + pixels[3*c+1] / 3 + pixels[3*c+2] / 3);
+	}
+
+#ifndef CVUTIL_SSE2
+	void gray_plain(const uchar* pixels, uchar* gray, int cols)
+	{
+		gray_scalar(pixels, gray, 0, cols);
+	}
+#else
+	/**
+	 * @brief divide3_sse2 Divides 16 channel values by 3.
+	 */
+	inline __m128i divide3_sse2(__m128i bytes)
+	{
+		const auto zero = _mm_setzero_si128();
+		const auto multiplier = _mm_set1_epi16(div3_multiplier);
+		return _mm_packus_epi16(_mm_mulhi_epu16(_mm_unpacklo_epi8(bytes, zero), multiplier),
+								_mm_mulhi_epu16(_mm_unpackhi_epi8(bytes, zero), multiplier));
+	}
+
+	void gray_sse2(const uchar* pixels, uchar* gray, int cols)
+	{
+		int c = 0;
+		for(; c + 32 <= cols; c += 32)
+		{
+			// The thirds of all 96 bytes, the sum of three thirds fits into a byte
+			__m128i parts[6];
+			for(int p = 0; p < 6; ++p)
+				parts[p] = divide3_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 3*c + 16*p)));
+
+			// Five rounds of interleaving the first with the second half separate the channels:
+			// parts[0..1] receive the blue, parts[2..3] the green and parts[4..5] the red bytes of the 32 pixels
+			for(int round = 0; round < 5; ++round)
+			{
+				const __m128i in[6] = {parts[0], parts[1], parts[2], parts[3], parts[4], parts[5]};
+				for(int i = 0; i < 3; ++i)
+				{
+					parts[2*i] = _mm_unpacklo_epi8(in[i], in[i+3]);
+					parts[2*i+1] = _mm_unpackhi_epi8(in[i], in[i+3]);
+				}
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(gray + c), _mm_add_epi8(_mm_add_epi8(parts[0], parts[2]), parts[4]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(gray + c + 16), _mm_add_epi8(_mm_add_epi8(parts[1], parts[3]), parts[5]));
+		}
+		gray_scalar(pixels, gray, c, cols);
+	}
+#endif
+
+#ifdef CVUTIL_SSSE3
+	/**
+	 * @brief The GrayShuffles struct Byte shuffles that gather channel ch of 16 BGR pixels from the part p of their 48 bytes.
+	 * Bytes from other parts are zeroed, so the three shuffles of a channel are combined with a bitwise or.
+	 */
+	struct GrayShuffles
+	{
+		alignas(16) signed char masks[3][3][16];
+
+		GrayShuffles()
+		{
+			for(int ch = 0; ch < 3; ++ch)
+				for(int p = 0; p < 3; ++p)
+					for(int i = 0; i < 16; ++i)
+						masks[ch][p][i] = static_cast<signed char>((3*i + ch) / 16 == p ? (3*i + ch) % 16 : -1);
+		}
+	};
+
+	CVUTIL_TARGET_SSSE3
+	void gray_ssse3(const uchar* pixels, uchar* gray, int cols)
+	{
+		static const GrayShuffles shuffles{};
+		__m128i masks[3][3];
+		for(int ch = 0; ch < 3; ++ch)
+			for(int p = 0; p < 3; ++p)
+				masks[ch][p] = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffles.masks[ch][p]));
+
+		int c = 0;
+		for(; c + 16 <= cols; c += 16)
+		{
+			// The thirds of all 48 bytes, the sum of three thirds fits into a byte
+			__m128i parts[3];
+			for(int p = 0; p < 3; ++p)
+				parts[p] = divide3_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 3*c + 16*p)));
+
+			auto sum = _mm_setzero_si128();
+			for(int ch = 0; ch < 3; ++ch)
+			{
+				const auto channel = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(parts[0], masks[ch][0]), _mm_shuffle_epi8(parts[1], masks[ch][1])),
+												  _mm_shuffle_epi8(parts[2], masks[ch][2]));
+				sum = _mm_add_epi8(sum, channel);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(gray + c), sum);
+		}
+		gray_scalar(pixels, gray, c, cols);
+	}
+#endif
+
+	/**
+	 * @brief window_terms_scalar Slides the histogram along the row, one column of the window enters and one leaves per pixel.
+	 * The sum of the terms follows every count change, so it never has to be summed up over the bins.
+	 */
+	void window_terms_scalar(const uchar* const* rows, int radius, const int* terms, int* sums, int cols)
+	{
+		const auto count = 2 * radius + 1;
+		int counts[16] = {};
+		auto sum = 0;
+		auto column = [rows, count, terms, &counts, &sum, cols] (int c, int change) {
+			c = std::min(std::max(c, 0), cols-1);
+			for(int k = 0; k < count; ++k)
+			{
+				auto& bin = counts[rows[k][c] >> 4];
+				sum -= terms[bin];
+				bin += change;
+				sum += terms[bin];
+			}
+		};
+
+		for(int c = -radius; c <= radius; ++c)
+			column(c, 1);
+		for(int c = 0; c < cols; ++c)
+		{
+			sums[c] = sum;
+			column(c - radius, -1);
+			column(c + radius + 1, 1);
+		}
+	}
+
+#ifdef CVUTIL_SSSE3
+	/**
+	 * @brief The BinOnes struct The histogram of a single value per bin: a one in the byte of the bin.
+	 */
+	struct BinOnes
+	{
+		alignas(16) uchar bytes[16][16];
+
+		BinOnes()
+		{
+			for(int bin = 0; bin < 16; ++bin)
+				for(int i = 0; i < 16; ++i)
+					bytes[bin][i] = bin == i ? 1 : 0;
+		}
+	};
+
+	/**
+	 * @brief column_histogram The bin counts of column c of the window rows, one byte per bin.
+	 */
+	inline __m128i column_histogram(const BinOnes& ones, const uchar* const* rows, int count, int c)
+	{
+		auto histogram = _mm_setzero_si128();
+		for(int k = 0; k < count; ++k)
+			histogram = _mm_add_epi8(histogram, _mm_load_si128(reinterpret_cast<const __m128i*>(ones.bytes[rows[k][c] >> 4])));
+		return histogram;
+	}
+
+	CVUTIL_TARGET_SSSE3
+	void window_terms_ssse3(const uchar* const* rows, int radius, const int* terms, int* sums, int cols)
+	{
+		static const BinOnes ones{};
+		const auto count = 2 * radius + 1;
+
+		// Byte k of the terms of the counts 0-15 (low) and 16-31 (high), the terms stay below 2^24
+		alignas(16) uchar planes[3][2][16] = {};
+		for(int n = 0; n <= count * count; ++n)
+			for(int k = 0; k < 3; ++k)
+				planes[k][n / 16][n % 16] = static_cast<uchar>(terms[n] >> (8 * k));
+		__m128i low[3];
+		__m128i high[3];
+		for(int k = 0; k < 3; ++k)
+		{
+			low[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(planes[k][0]));
+			high[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(planes[k][1]));
+		}
+
+		// The column histograms of the window, the one of the column that leaves it next is at position first
+		__m128i columns[5];
+		auto histogram = _mm_setzero_si128();
+		for(int i = 0; i < count; ++i)
+		{
+			columns[i] = column_histogram(ones, rows, count, std::min(std::max(i - radius, 0), cols-1));
+			histogram = _mm_add_epi8(histogram, columns[i]);
+		}
+		auto first = 0;
+
+		const auto zero = _mm_setzero_si128();
+		const auto low_offset = _mm_set1_epi8(0x70);
+		const auto high_offset = _mm_set1_epi8(16);
+		for(int c = 0; c < cols; ++c)
+		{
+			// A shuffle index with bit 7 set yields zero: counts from 16 on saturate the low index, smaller ones wrap the high index
+			const auto low_index = _mm_adds_epu8(histogram, low_offset);
+			const auto high_index = _mm_sub_epi8(histogram, high_offset);
+			__m128i bytes[3];
+			for(int k = 0; k < 3; ++k)
+				bytes[k] = _mm_or_si128(_mm_shuffle_epi8(low[k], low_index), _mm_shuffle_epi8(high[k], high_index));
+
+			// The bytes of all bins are summed per plane, then the planes are weighted by their place
+			auto sum = _mm_sad_epu8(bytes[0], zero);
+			sum = _mm_add_epi64(sum, _mm_slli_epi64(_mm_sad_epu8(bytes[1], zero), 8));
+			sum = _mm_add_epi64(sum, _mm_slli_epi64(_mm_sad_epu8(bytes[2], zero), 16));
+			sums[c] = _mm_cvtsi128_si32(_mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum)));
+
+			const auto entering = column_histogram(ones, rows, count, std::min(c + radius + 1, cols-1));
+			histogram = _mm_add_epi8(_mm_sub_epi8(histogram, columns[first]), entering);
+			columns[first] = entering;
+			first = first + 1 == count ? 0 : first + 1;
+		}
+	}
+#endif
+
+	GrayFunction select_gray()
+	{
+#ifdef CVUTIL_SSSE3
+		if(cvutil::simd::has_ssse3())
+			return gray_ssse3;
+#endif
+#ifdef CVUTIL_SSE2
+		return gray_sse2;
+#else
+		return gray_plain;
+#endif
+	}
+
+	InteriorFunction select_interior()
+	{
+#ifdef CVUTIL_AVX2
+		if(cvutil::simd::has_avx2())
+			return interior_avx2;
+#endif
+#ifdef CVUTIL_SSE2
+		return interior_sse2;
+#else
+		return interior_scalar;
+#endif
+	}
+
+	TermsFunction select_window_terms()
+	{
+#ifdef CVUTIL_SSSE3
+		if(cvutil::simd::has_ssse3())
+			return window_terms_ssse3;
+#endif
+		return window_terms_scalar;
+	}
+}
+
+void cvutil::kernel::sobel_row(const uchar* above, const uchar* row, const uchar* below, uchar* out, int cols)
+{
+	static const auto interior = select_interior();
+
+	out[0] = sobel_pixel(above, row, below, 0, cols);
+	if(cols > 2)
+		interior(above, row, below, out, 1, cols-1);
+	if(cols > 1)
+		out[cols-1] = sobel_pixel(above, row, below, cols-1, cols);
+}
+
+void cvutil::kernel::gray_row(const uchar* pixels, uchar* gray, int cols)
+{
+	static const auto convert = select_gray();
+	convert(pixels, gray, cols);
+}
+
+void cvutil::kernel::gradient_row(const uchar* above, const uchar* row, const uchar* below, ushort* out, int begin, int end, int stride)
+{
+	auto i = begin;
+#ifdef CVUTIL_SSE2
+	const auto zero = _mm_setzero_si128();
+	auto load = [] (const uchar* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+	for(; i + 16 <= end; i += 16)
+	{
+		const auto al = load(above + i - stride), am = load(above + i), ar = load(above + i + stride);
+		const auto rl = load(row + i - stride), rr = load(row + i + stride);
+		const auto bl = load(below + i - stride), bm = load(below + i), br = load(below + i + stride);
+
+		const auto lo = gradient8_sse2(_mm_unpacklo_epi8(al, zero), _mm_unpacklo_epi8(am, zero), _mm_unpacklo_epi8(ar, zero),
+									   _mm_unpacklo_epi8(rl, zero), _mm_unpacklo_epi8(rr, zero),
+									   _mm_unpacklo_epi8(bl, zero), _mm_unpacklo_epi8(bm, zero), _mm_unpacklo_epi8(br, zero));
+		const auto hi = gradient8_sse2(_mm_unpackhi_epi8(al, zero), _mm_unpackhi_epi8(am, zero), _mm_unpackhi_epi8(ar, zero),
+									   _mm_unpackhi_epi8(rl, zero), _mm_unpackhi_epi8(rr, zero),
+									   _mm_unpackhi_epi8(bl, zero), _mm_unpackhi_epi8(bm, zero), _mm_unpackhi_epi8(br, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), hi);
+	}
+#endif
+	for(; i < end; ++i)
+	{
+		const int grad_h = (above[i+stride] + row[i+stride] + below[i+stride]) - (above[i-stride] + row[i-stride] + below[i-stride]);
+		const int grad_v = (below[i-stride] + below[i] + below[i+stride]) - (above[i-stride] + above[i] + above[i+stride]);
+		out[i] = static_cast<ushort>(std::abs(grad_h) + std::abs(grad_v));
+	}
+}
+
+void cvutil::kernel::column_sums(const uchar* const* rows, int count, ushort* sums, int cols)
+{
+	auto c = 0;
+#ifdef CVUTIL_SSE2
+	const auto zero = _mm_setzero_si128();
+	for(; c + 16 <= cols; c += 16)
+	{
+		auto lo = _mm_setzero_si128();
+		auto hi = _mm_setzero_si128();
+		for(int k = 0; k < count; ++k)
+		{
+			const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + c));
+			lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(bytes, zero));
+			hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(bytes, zero));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(sums + c), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(sums + c + 8), hi);
+	}
+#endif
+	for(; c < cols; ++c)
+	{
+		auto sum = 0;
+		for(int k = 0; k < count; ++k)
+			sum += rows[k][c];
+		sums[c] = static_cast<ushort>(sum);
+	}
+}
+
+void cvutil::kernel::window_terms(const uchar* const* rows, int radius, const int* terms, int* sums, int cols)
+{
+	static const auto slide = select_window_terms();
+	slide(rows, radius, terms, sums, cols);
+}
@@ -0,0 +1,84 @@
+#ifndef ENERGY_KERNEL_H
+#define ENERGY_KERNEL_H
+
+#include "opencv2/core/core.hpp"
+
+namespace cvutil::kernel
+{
+	/**
+	 * @brief sobel_pixel Calculates the energy of one pixel from three row pointers, clamping the column coordinates at the border.
+	 * @param above The row above (the row itself at the top border).
+	 * @param row The row of the pixel.
+	 * @param below The row below (the row itself at the bottom border).
+	 * @param col The column of the pixel.
+	 * @param cols The number of columns of the rows.
+	 * @return The sum of absolute Sobel gradients divided by 6.
+	 */
+	inline uchar sobel_pixel(const uchar* above, const uchar* row, const uchar* below, int col, int cols)
+	{
+		const auto left = std::max(col-1, 0);
+		const auto right = std::min(col+1, cols-1);
+		const int grad_h = (above[right] + row[right] + below[right]) - (above[left] + row[left] + below[left]);
+		const int grad_v = (below[left] + below[col] + below[right]) - (above[left] + above[col] + above[right]);
+		return static_cast<uchar>((std::abs(grad_h) + std::abs(grad_v))/6);
+	}
+
+	/**
+	 * @brief sobel_row Calculates the energy of a whole row with separable Sobel sums.
+	 * The interior is computed with the widest instruction set the CPU supports (AVX2, SSE2 or scalar, chosen once at runtime),
+	 * only the first and last column go through sobel_pixel. The result is bit identical on every path.
+	 * @param above The row above (the row itself at the top border).
+	 * @param row The row of the pixels.
+	 * @param below The row below (the row itself at the bottom border).
+	 * @param out Receives cols energy values.
+	 * @param cols The number of columns of the rows.
+	 */
+	void sobel_row(const uchar* above, const uchar* row, const uchar* below, uchar* out, int cols);
+
+	/**
+	 * @brief gradient_row Sums of absolute Sobel gradients of the bytes [begin, end), without scaling, 16 per SSE2 step.
+	 * The neighbours of a byte lie stride bytes apart, so a stride of 3 runs the Sobel operator on every channel of a BGR row.
+	 * @param above The row above (the row itself at the top border).
+	 * @param row The row of the pixels.
+	 * @param below The row below (the row itself at the bottom border).
+	 * @param out Receives the sums [0, 1530] at the same indices.
+	 * @param begin The first byte, at least stride.
+	 * @param end The byte after the last one, at most the row length minus stride.
+	 * @param stride The distance of neighbouring bytes.
+	 */
+	void gradient_row(const uchar* above, const uchar* row, const uchar* below, ushort* out, int begin, int end, int stride);
+
+	/**
+	 * @brief column_sums Adds up count rows column by column, 16 columns per SSE2 step.
+	 * @param rows The row pointers, at most 257 so the sums fit into 16 bits.
+	 * @param count The number of rows.
+	 * @param sums Receives cols sums.
+	 * @param cols The number of columns.
+	 */
+	void column_sums(const uchar* const* rows, int count, ushort* sums, int cols);
+
+	/**
+	 * @brief window_terms Sums a table over the histogram of the square window around every pixel of a row.
+	 * The bins are the high nibbles of the values, 16 of them. Columns outside of the row repeat the border columns.
+	 * With SSSE3 support the window histogram is one vector that gains and loses a column histogram per pixel, and the table
+	 * is looked up for all bins at once with byte shuffles, otherwise the bins are updated one by one.
+	 * @param rows The 2 * radius + 1 row pointers of the window.
+	 * @param radius The radius of the window, at most 2 so the counts index a table of at most 32 entries.
+	 * @param terms The table, indexed by the count of a bin from 0 to the window size, every entry below 2^24.
+	 * @param sums Receives the sum of the terms of all bins for cols pixels.
+	 * @param cols The number of columns.
+	 */
+	void window_terms(const uchar* const* rows, int radius, const int* terms, int* sums, int cols);
+
+	/**
+	 * @brief gray_row Averages the channels of a BGR row exactly like cvutil::grayscale: every channel is divided by 3 first.
+	 * With SSSE3 support 16 pixels are divided per step and their channels gathered with byte shuffles, with SSE2 32 pixels
+	 * are divided per step and their channels separated by unpacking.
+	 * @param pixels The 8UC3 row.
+	 * @param gray Receives cols gray values.
+	 * @param cols The number of pixels of the row.
+	 */
+	void gray_row(const uchar* pixels, uchar* gray, int cols);
+}
+
+#endif // ENERGY_KERNEL_H
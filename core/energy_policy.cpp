@@ -0,0 +1,174 @@
+#include "energy_policy.h"
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	constexpr int entropy_window = 25;		// Pixels of the 5x5 window
+	constexpr int entropy_bins = 16;		// Gray values are quantized to 4 bits
+	constexpr int entropy_scale = 1024;		// Fixed point scale of n * log2(n)
+
+	/**
+	 * @brief entropy_terms n * log2(n) * entropy_scale, rounded, for every count of a bin.
+	 */
+	const std::array<int, entropy_window + 1>& entropy_terms()
+	{
+		static const auto terms = [] {
+			auto table = std::array<int, entropy_window + 1>{};
+			for(int n = 1; n <= entropy_window; ++n)
+				table[static_cast<size_t>(n)] = static_cast<int>(std::lround(n * std::log2(n) * entropy_scale));
+			return table;
+		}();
+		return terms;
+	}
+
+	/**
+	 * @brief entropy_value Scales the entropy to [0, 255], given the sum of the terms of all bins.
+	 * The entropy is log2(window) - terms / window and at most log2(entropy_bins) = 4 bits.
+	 */
+	inline uchar entropy_value(int terms)
+	{
+		const auto scaled = (entropy_terms()[entropy_window] - terms) * 255 / (entropy_window * 4 * entropy_scale);
+		return static_cast<uchar>(std::min(std::max(scaled, 0), 255));
+	}
+
+	constexpr int saliency_window = 81;		// Pixels of the 9x9 window
+
+	/**
+	 * @brief saliency_value Twice the difference between a gray value and the window mean, saturated.
+	 */
+	inline uchar saliency_value(int value, int sum)
+	{
+		return static_cast<uchar>(std::min(2 * std::abs(saliency_window * value - sum) / saliency_window, 255));
+	}
+}
+
+cvutil::ColorGradientEnergy::ColorGradientEnergy(int cols) :
+	sums(3 * static_cast<size_t>(cols))
+{}
+
+void cvutil::ColorGradientEnergy::row(const cv::Mat& source, int r, uchar* out)
+{
+	const auto cols = source.cols;
+	const auto above = source.ptr<uchar>(std::max(r-1, 0));
+	const auto here = source.ptr<uchar>(r);
+	const auto below = source.ptr<uchar>(std::min(r+1, source.rows-1));
+
+	// The interleaved channels of the interior pixels, the border pixels clamp their columns
+	if(cols > 2)
+		kernel::gradient_row(above, here, below, sums.data(), 3, 3 * (cols-1), 3);
+	for(int c = 1; c < cols-1; ++c)
+		out[c] = static_cast<uchar>((sums[3*c] + sums[3*c+1] + sums[3*c+2]) / 18);
+	out[0] = pixel(source, r, 0);
+	if(cols > 1)
+		out[cols-1] = pixel(source, r, cols-1);
+}
+
+uchar cvutil::ColorGradientEnergy::pixel(const cv::Mat& source, int r, int c)
+{
+	const auto above = source.ptr<uchar>(std::max(r-1, 0));
+	const auto here = source.ptr<uchar>(r);
+	const auto below = source.ptr<uchar>(std::min(r+1, source.rows-1));
+	const auto left = 3 * std::max(c-1, 0);
+	const auto centre = 3 * c;
+	const auto right = 3 * std::min(c+1, source.cols-1);
+
+	auto sum = 0;
+	for(int ch = 0; ch < 3; ++ch)
+	{
+		const int grad_h = (above[right+ch] + here[right+ch] + below[right+ch]) - (above[left+ch] + here[left+ch] + below[left+ch]);
+		const int grad_v = (below[left+ch] + below[centre+ch] + below[right+ch]) - (above[left+ch] + above[centre+ch] + above[right+ch]);
+		sum += std::abs(grad_h) + std::abs(grad_v);
+	}
+	return static_cast<uchar>(sum / 18);
+}
+
+cvutil::EntropyEnergy::EntropyEnergy(int cols) :
+	sums(static_cast<size_t>(cols))
+{}
+
+void cvutil::EntropyEnergy::row(const cv::Mat& source, int r, uchar* out)
+{
+	const uchar* rows[2 * radius + 1];
+	for(int i = -radius; i <= radius; ++i)
+		rows[i + radius] = source.ptr<uchar>(std::min(std::max(r + i, 0), source.rows-1));
+
+	kernel::window_terms(rows, radius, entropy_terms().data(), sums.data(), source.cols);
+	for(int c = 0; c < source.cols; ++c)
+		out[c] = entropy_value(sums[static_cast<size_t>(c)]);
+}
+
+uchar cvutil::EntropyEnergy::pixel(const cv::Mat& source, int r, int c)
+{
+	const auto& terms = entropy_terms();
+	int counts[entropy_bins] = {};
+	for(int i = r - radius; i <= r + radius; ++i)
+	{
+		const auto row = source.ptr<uchar>(std::min(std::max(i, 0), source.rows-1));
+		for(int j = c - radius; j <= c + radius; ++j)
+			++counts[row[std::min(std::max(j, 0), source.cols-1)] >> 4];
+	}
+
+	auto sum = 0;
+	for(const auto count : counts)
+		sum += terms[static_cast<size_t>(count)];
+	return entropy_value(sum);
+}
+
+cvutil::SaliencyEnergy::SaliencyEnergy(int cols) :
+	sums(static_cast<size_t>(cols))
+{}
+
+void cvutil::SaliencyEnergy::row(const cv::Mat& source, int r, uchar* out)
+{
+	const auto cols = source.cols;
+	const uchar* rows[2 * radius + 1];
+	for(int i = -radius; i <= radius; ++i)
+		rows[i + radius] = source.ptr<uchar>(std::min(std::max(r + i, 0), source.rows-1));
+	kernel::column_sums(rows, 2 * radius + 1, sums.data(), cols);
+
+	// The window sum slides along the row, one column sum enters and one leaves per pixel
+	auto column = [this, cols] (int c) { return static_cast<int>(sums[static_cast<size_t>(std::min(std::max(c, 0), cols-1))]); };
+	auto sum = 0;
+	for(int c = -radius; c <= radius; ++c)
+		sum += column(c);
+
+	const auto here = rows[radius];
+	for(int c = 0; c < cols; ++c)
+	{
+		out[c] = saliency_value(here[c], sum);
+		sum += column(c + radius + 1) - column(c - radius);
+	}
+}
+
+uchar cvutil::SaliencyEnergy::pixel(const cv::Mat& source, int r, int c)
+{
+	auto sum = 0;
+	for(int i = r - radius; i <= r + radius; ++i)
+	{
+		const auto row = source.ptr<uchar>(std::min(std::max(i, 0), source.rows-1));
+		for(int j = c - radius; j <= c + radius; ++j)
+			sum += row[std::min(std::max(j, 0), source.cols-1)];
+	}
+	return saliency_value(source.ptr<uchar>(r)[c], sum);
+}
+
+cvutil::EnergyFunctions cvutil::energy_functions(EnergyKernel kernel)
+{
+	switch(kernel)
+	{
+	case EnergyKernel::sobel:
+		return EnergyFunctions{SobelEnergy::source_type, SobelEnergy::radius, energy_map<SobelEnergy>, update_energy<SobelEnergy>};
+	case EnergyKernel::color_gradient:
+		return EnergyFunctions{ColorGradientEnergy::source_type, ColorGradientEnergy::radius, energy_map<ColorGradientEnergy>, update_energy<ColorGradientEnergy>};
+	case EnergyKernel::entropy:
+		return EnergyFunctions{EntropyEnergy::source_type, EntropyEnergy::radius, energy_map<EntropyEnergy>, update_energy<EntropyEnergy>};
+	case EnergyKernel::saliency:
+		return EnergyFunctions{SaliencyEnergy::source_type, SaliencyEnergy::radius, energy_map<SaliencyEnergy>, update_energy<SaliencyEnergy>};
+	}
+
+	std::cout << "ERROR: Unknown energy kernel. Energy function not supported!" << std::endl;
+	throw std::invalid_argument{"Energy function selected with invalid kernel"};
+}
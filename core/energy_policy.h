@@ -0,0 +1,214 @@
+#ifndef ENERGY_POLICY_H
+#define ENERGY_POLICY_H
+
+#include "cv_utility.h"
+#include "energy_kernel.h"
+#include "thread_pool.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief The EnergyKernel enum The energy function behind the energy map of backward energy.
+	 */
+	enum class EnergyKernel
+	{
+		sobel,			// Sum of absolute Sobel gradients of the grayscale image (SobelEnergy)
+		color_gradient,	// Sum of absolute Sobel gradients of every color channel (ColorGradientEnergy)
+		entropy,		// Entropy of the gray values around the pixel (EntropyEnergy)
+		saliency		// Contrast of the pixel against its surround (SaliencyEnergy)
+	};
+
+	/*
+	 * Energy policies. Every policy is a class with
+	 *
+	 *	static constexpr int radius			The energy of a pixel depends on the (2 * radius + 1)^2 pixels around it
+	 *	static constexpr int source_type	CV_8UC1 for the grayscale image, CV_8UC3 for the color image
+	 *	explicit Policy(int cols)			Allocates the scratch buffers of one thread for rows of cols pixels
+	 *	void row(source, r, out)			Computes row r of the energy map, vectorized where the kernel allows it
+	 *	static uchar pixel(source, r, c)	Computes one pixel, bit identical to row()
+	 *
+	 * Pixels outside of the image repeat the border pixels and the neighbourhood is a square, so the energy map of the
+	 * transposed image is the transposed energy map. The SeamCarver relies on that when it changes the orientation.
+	 */
+
+	/**
+	 * @brief The SobelEnergy class The energy of cvutil::energy: absolute Sobel gradients of the grayscale image, divided by 6.
+	 */
+	class SobelEnergy
+	{
+	public:
+		static constexpr int radius = 1;
+		static constexpr int source_type = CV_8UC1;
+
+		explicit SobelEnergy(int) {}
+
+		void row(const cv::Mat& source, int r, uchar* out) const
+		{
+			kernel::sobel_row(source.ptr<uchar>(std::max(r-1, 0)), source.ptr<uchar>(r), source.ptr<uchar>(std::min(r+1, source.rows-1)), out, source.cols);
+		}
+
+		static uchar pixel(const cv::Mat& source, int r, int c)
+		{
+			return kernel::sobel_pixel(source.ptr<uchar>(std::max(r-1, 0)), source.ptr<uchar>(r), source.ptr<uchar>(std::min(r+1, source.rows-1)), c, source.cols);
+		}
+	};
+
+	/**
+	 * @brief The ColorGradientEnergy class Absolute Sobel gradients of every channel of the color image, summed and divided by 18.
+	 * Edges between colors of equal brightness, which the grayscale image loses, keep their energy.
+	 */
+	class ColorGradientEnergy
+	{
+	public:
+		static constexpr int radius = 1;
+		static constexpr int source_type = CV_8UC3;
+
+		explicit ColorGradientEnergy(int cols);
+
+		/**
+		 * @brief row Runs the Sobel operator on the interleaved bytes with kernel::gradient_row, then sums the channels.
+		 */
+		void row(const cv::Mat& source, int r, uchar* out);
+		static uchar pixel(const cv::Mat& source, int r, int c);
+
+	private:
+		std::vector<ushort> sums;
+	};
+
+	/**
+	 * @brief The EntropyEnergy class Shannon entropy of the gray values in the 5x5 window, quantized to 16 bins.
+	 * Textured regions get high energy even where single gradients are weak. The entropy is computed from integer
+	 * n * log2(n) values, so a sliding histogram per row gives exactly the result of the window histogram per pixel.
+	 */
+	class EntropyEnergy
+	{
+	public:
+		static constexpr int radius = 2;
+		static constexpr int source_type = CV_8UC1;
+
+		explicit EntropyEnergy(int cols);
+
+		/**
+		 * @brief row Slides the histogram along the row with kernel::window_terms, one column of the window enters and one
+		 * leaves per pixel.
+		 */
+		void row(const cv::Mat& source, int r, uchar* out);
+		static uchar pixel(const cv::Mat& source, int r, int c);
+
+	private:
+		std::vector<int> sums;
+	};
+
+	/**
+	 * @brief The SaliencyEnergy class Centre-surround contrast: twice the absolute difference between a gray value and the
+	 * mean of its 9x9 window, saturated at 255. Pixels that stand out from their surround are protected.
+	 */
+	class SaliencyEnergy
+	{
+	public:
+		static constexpr int radius = 4;
+		static constexpr int source_type = CV_8UC1;
+
+		explicit SaliencyEnergy(int cols);
+
+		/**
+		 * @brief row Sums the window rows with kernel::column_sums, then slides the window sum along the row.
+		 */
+		void row(const cv::Mat& source, int r, uchar* out);
+		static uchar pixel(const cv::Mat& source, int r, int c);
+
+	private:
+		std::vector<ushort> sums;
+	};
+
+	template<typename Energy>
+	/**
+	 * @brief energy_map Computes the energy map of a whole image with one policy object per thread.
+	 * @param source The grayscale or color image, as the policy requires.
+	 * @return The 8UC1 energy map.
+	 */
+	cv::Mat energy_map(const cv::Mat& source)
+	{
+		if(source.type() != Energy::source_type)
+		{
+			std::cout << "ERROR: Image type does not match up with the energy function. Energy function not supported!" << std::endl;
+			throw std::invalid_argument{"Energy function applied to image with invalid type"};
+		}
+
+		auto energy = cv::Mat(source.size(), CV_8UC1);
+
+		// Multithreading, one block of rows per thread
+		thread_pool().parallel_for(0, source.rows, [&source, &energy] (int start, int end) {
+			auto kernel = Energy{source.cols};
+			for(int r = start; r < end; ++r)
+				kernel.row(source, r, energy.ptr<uchar>(r));
+		});
+		return energy;
+	}
+
+	template<typename Energy>
+	/**
+	 * @brief update_energy Updates an energy map after a vertical seam was removed from its source image.
+	 * Generalizes update_vertical_energy to any radius: only the pixels whose window contained the seam are recomputed.
+	 * @param energy The energy map of the source before the removal, the seam is removed from it.
+	 * @param source The source image after the removal.
+	 * @param seam The removed seam.
+	 */
+	void update_energy(cv::Mat& energy, const cv::Mat& source, const std::vector<int>& seam)
+	{
+		if(source.type() != Energy::source_type || energy.type() != CV_8UC1)
+		{
+			std::cout << "ERROR: Image type does not match up with the energy function. Energy update not supported!" << std::endl;
+			throw std::invalid_argument{"Energy update applied to image with invalid type"};
+		}
+		if(energy.rows != source.rows || energy.cols != source.cols+1)
+		{
+			std::cout << "ERROR: Energy map does not match up with the carved image. Energy update not supported!" << std::endl;
+			throw std::invalid_argument{"Energy update applied to mismatching energy and image"};
+		}
+
+		remove_vertical_seam<uchar>(energy, seam);
+
+		// A pixel keeps its energy if its window lies on one side of the seam in every row of the window
+		constexpr auto radius = Energy::radius;
+		for(int r = 0; r < source.rows; ++r)
+		{
+			auto lowest = seam[static_cast<size_t>(r)];
+			auto highest = lowest;
+			for(int i = std::max(r - radius, 0); i <= std::min(r + radius, source.rows-1); ++i)
+			{
+				lowest = std::min(lowest, seam[static_cast<size_t>(i)]);
+				highest = std::max(highest, seam[static_cast<size_t>(i)]);
+			}
+
+			auto out = energy.ptr<uchar>(r);
+			for(int c = std::max(lowest - radius, 0); c <= std::min(highest + radius - 1, source.cols-1); ++c)
+				out[c] = Energy::pixel(source, r, c);
+		}
+	}
+
+	/**
+	 * @brief The EnergyFunctions struct The instantiations of one energy policy, selected at runtime once per image or seam.
+	 */
+	struct EnergyFunctions
+	{
+		int source_type;
+		int radius;
+		cv::Mat (*map)(const cv::Mat&);
+		void (*update)(cv::Mat&, const cv::Mat&, const std::vector<int>&);
+	};
+
+	/**
+	 * @brief energy_functions The functions of the policy behind an energy kernel.
+	 */
+	EnergyFunctions energy_functions(EnergyKernel kernel);
+}
+
+#endif // ENERGY_POLICY_H
@@ -0,0 +1,148 @@
+#include "mapped_file.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CVUTIL_MMAP
+#endif
+
+namespace
+{
+	[[noreturn]] void file_error(const std::string& path, const std::string& reason)
+	{
+		std::cout << "ERROR: " << reason << ": " << path << std::endl;
+		throw std::runtime_error{"Mapped file failed, " + reason + ": " + path};
+	}
+}
+
+cvutil::MappedFile::Window::Window(Window&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+cvutil::MappedFile::Window& cvutil::MappedFile::Window::operator=(Window&& other) noexcept
+{
+	std::swap(base, other.base);
+	std::swap(length, other.length);
+	std::swap(begin, other.begin);
+	std::swap(bytes, other.bytes);
+	return *this;
+}
+
+cvutil::MappedFile::Window::~Window()
+{
+#ifdef CVUTIL_MMAP
+	if(base != nullptr)
+		munmap(base, length);
+#endif
+}
+
+unsigned char* cvutil::MappedFile::Window::data() const
+{
+	return begin;
+}
+
+size_t cvutil::MappedFile::Window::size() const
+{
+	return bytes;
+}
+
+cvutil::MappedFile::MappedFile(const std::string& path, size_t size) :
+	path{path}
+{
+#ifdef CVUTIL_MMAP
+	descriptor = size == 0 ? open(path.c_str(), O_RDWR) : open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(descriptor < 0)
+		file_error(path, "Cannot open");
+
+	if(size == 0)
+	{
+		struct stat status{};
+		if(fstat(descriptor, &status) != 0)
+		{
+			close(descriptor);
+			file_error(path, "Cannot read the size");
+		}
+		file_size = static_cast<size_t>(status.st_size);
+	}
+	else
+	{
+		try
+		{
+			resize(size);
+		}
+		catch(...)
+		{
+			close(descriptor);
+			throw;
+		}
+	}
+#else
+	file_error(path, "Memory mapped files are not supported on this platform");
+#endif
+}
+
+cvutil::MappedFile::~MappedFile()
+{
+#ifdef CVUTIL_MMAP
+	if(descriptor >= 0)
+		close(descriptor);
+#endif
+}
+
+size_t cvutil::MappedFile::size() const
+{
+	return file_size;
+}
+
+void cvutil::MappedFile::resize(size_t size)
+{
+#ifdef CVUTIL_MMAP
+	if(ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+		file_error(path, "Cannot resize");
+	file_size = size;
+#else
+	(void)size;
+#endif
+}
+
+cvutil::MappedFile::Window cvutil::MappedFile::map(size_t offset, size_t length)
+{
+	if(length == 0 || offset + length > file_size)
+	{
+		std::cout << "ERROR: Window exceeds the file. Mapping not supported!" << std::endl;
+		throw std::invalid_argument{"Mapping applied to a range outside of the file"};
+	}
+
+	auto window = Window{};
+#ifdef CVUTIL_MMAP
+	// Mappings start at page boundaries
+	const auto aligned = offset - offset % page_size();
+	window.length = length + (offset - aligned);
+	window.base = mmap(nullptr, window.length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, static_cast<off_t>(aligned));
+	if(window.base == MAP_FAILED)
+	{
+		window.base = nullptr;
+		file_error(path, "Cannot map");
+	}
+	window.begin = static_cast<unsigned char*>(window.base) + (offset - aligned);
+	window.bytes = length;
+#endif
+	return window;
+}
+
+size_t cvutil::MappedFile::page_size()
+{
+#ifdef CVUTIL_MMAP
+	static const auto size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	return size;
+#else
+	return 4096;
+#endif
+}
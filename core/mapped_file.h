@@ -0,0 +1,92 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace cvutil
+{
+	/**
+	 * @brief The MappedFile class A file that is mapped into memory one window at a time, read and write.
+	 * Only the windows in use occupy address space, so files larger than the memory are processed in strips.
+	 * Uses POSIX mmap, other platforms report the mapping as not supported.
+	 */
+	class MappedFile
+	{
+	public:
+		/**
+		 * @brief The Window class A mapped byte range of the file, unmapped on destruction.
+		 */
+		class Window
+		{
+		public:
+			Window() = default;
+			Window(const Window&) = delete;
+			Window(Window&& other) noexcept;
+			Window& operator=(const Window&) = delete;
+			Window& operator=(Window&& other) noexcept;
+			~Window();
+
+			/**
+			 * @brief data The first byte of the requested range.
+			 */
+			unsigned char* data() const;
+
+			/**
+			 * @brief size The length of the requested range in bytes.
+			 */
+			size_t size() const;
+
+		private:
+			friend class MappedFile;
+
+			void* base{nullptr};		// Page aligned start of the mapping
+			size_t length{0};			// Length of the mapping
+			unsigned char* begin{nullptr};
+			size_t bytes{0};
+		};
+
+		/**
+		 * @brief MappedFile Opens an existing file, or creates one of the given size.
+		 * @param path The file.
+		 * @param size 0 opens the existing file, any other value creates or truncates the file to that many bytes.
+		 * @throws std::runtime_error if the file cannot be opened or resized.
+		 */
+		explicit MappedFile(const std::string& path, size_t size = 0);
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		/**
+		 * @brief size The length of the file in bytes.
+		 */
+		size_t size() const;
+
+		/**
+		 * @brief resize Truncates or extends the file. No window may be mapped beyond the new size.
+		 * @param size The new length in bytes.
+		 */
+		void resize(size_t size);
+
+		/**
+		 * @brief map Maps a byte range of the file. Changes are written back to the file.
+		 * @param offset The first byte, any position.
+		 * @param length The number of bytes, offset + length <= size().
+		 * @return The window, which occupies at most one page more than length.
+		 */
+		Window map(size_t offset, size_t length);
+
+		/**
+		 * @brief page_size The alignment of mappings in bytes.
+		 */
+		static size_t page_size();
+
+	private:
+		std::string path;
+		int descriptor{-1};
+		size_t file_size{0};
+	};
+}
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,176 @@
+#include "route_matrix.h"
+
+#include "simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	constexpr size_t line = 64;
+}
+
+void cvutil::pack_routes(const signed char* offsets, uchar* packed, int begin, int end)
+{
+	auto c = begin;
+#ifdef CVUTIL_SSE2
+	// Codes of 4 bytes are merged into the lowest one: first pairs within 16 bits, then pairs of pairs within 32 bits
+	const auto codes = _mm_set1_epi8(3);
+	const auto low = _mm_set1_epi32(0xFF);
+	auto merge = [&codes, &low] (const signed char* cells) {
+		auto v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells)), codes);
+		v = _mm_or_si128(v, _mm_srli_epi16(v, 6));
+		v = _mm_or_si128(v, _mm_srli_epi32(v, 12));
+		return _mm_and_si128(v, low);
+	};
+	for(; c + 64 <= end; c += 64)
+	{
+		const auto first = _mm_packs_epi32(merge(offsets + c), merge(offsets + c + 16));
+		const auto second = _mm_packs_epi32(merge(offsets + c + 32), merge(offsets + c + 48));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(packed + c / 4), _mm_packus_epi16(first, second));
+	}
+#endif
+	for(; c < end; c += 4)
+	{
+		auto code = 0;
+		for(int i = 0; i < 4 && c + i < end; ++i)
+			code |= (offsets[c + i] & 3) << (2 * i);
+		packed[c / 4] = static_cast<uchar>(code);
+	}
+}
+
+cvutil::RouteMatrix::RouteMatrix(const RouteMatrix& other)
+{
+	if(other.empty())
+		return;
+
+	create(other.row_count, other.col_count);
+	std::memcpy(data, other.data, bytes());
+}
+
+cvutil::RouteMatrix& cvutil::RouteMatrix::operator=(const RouteMatrix& other)
+{
+	return *this = RouteMatrix(other);
+}
+
+int cvutil::RouteMatrix::block_begin(int cols, int t, int count, int cells)
+{
+	if(t >= count)
+		return cols;
+	return static_cast<int>(static_cast<long long>(cols) * t / count / cells * cells);
+}
+
+size_t cvutil::RouteMatrix::row_step(int cols)
+{
+	return (static_cast<size_t>(cols + 3) / 4 + line - 1) / line * line;
+}
+
+void cvutil::RouteMatrix::reserve(cv::Size size)
+{
+	const auto needed = std::max(row_step(size.width) * static_cast<size_t>(size.height), row_step(size.height) * static_cast<size_t>(size.width)) + line - 1;
+	if(buffer.size() < needed)
+	{
+		// The cells are undefined after reserve, like after create
+		buffer.resize(needed);
+		const auto address = reinterpret_cast<std::uintptr_t>(buffer.data());
+		data = buffer.data() + (line - address % line) % line;
+	}
+}
+
+void cvutil::RouteMatrix::create(int rows, int cols)
+{
+	reserve(cv::Size(cols, rows));
+	row_count = rows;
+	col_count = cols;
+	row_bytes = row_step(cols);
+}
+
+void cvutil::RouteMatrix::release()
+{
+	row_count = 0;
+	col_count = 0;
+}
+
+bool cvutil::RouteMatrix::empty() const
+{
+	return row_count == 0;
+}
+
+int cvutil::RouteMatrix::rows() const
+{
+	return row_count;
+}
+
+int cvutil::RouteMatrix::cols() const
+{
+	return col_count;
+}
+
+size_t cvutil::RouteMatrix::step() const
+{
+	return row_bytes;
+}
+
+size_t cvutil::RouteMatrix::bytes() const
+{
+	return row_bytes * static_cast<size_t>(row_count);
+}
+
+uchar* cvutil::RouteMatrix::ptr(int r)
+{
+	return data + row_bytes * static_cast<size_t>(r);
+}
+
+const uchar* cvutil::RouteMatrix::ptr(int r) const
+{
+	return data + row_bytes * static_cast<size_t>(r);
+}
+
+int cvutil::RouteMatrix::at(int r, int c) const
+{
+	return route_at(ptr(r), c);
+}
+
+void cvutil::RouteMatrix::set(int r, int c, int offset)
+{
+	auto& byte = ptr(r)[c / 4];
+	const auto shift = 2 * (c % 4);
+	byte = static_cast<uchar>((byte & ~(3 << shift)) | ((offset & 3) << shift));
+}
+
+void cvutil::RouteMatrix::remove_vertical_seam(const std::vector<int>& seam)
+{
+	const auto last = (col_count - 1) / 4;	// The last byte in use
+	for(int r = 0; r < row_count; ++r)
+	{
+		auto row = ptr(r);
+		const auto c = seam[static_cast<size_t>(r)];
+
+		// The byte of the removed cell keeps the cells left of it, then every byte takes the first cell of the next one
+		const auto first = c / 4;
+		const auto shift = 2 * (c % 4);
+		const auto low = row[first] & ((1 << shift) - 1);
+		row[first] = static_cast<uchar>(low | ((row[first] >> (shift + 2)) << shift));
+		if(first < last)
+			row[first] = static_cast<uchar>(row[first] | (row[first+1] << 6));
+		for(int i = first + 1; i < last; ++i)
+			row[i] = static_cast<uchar>((row[i] >> 2) | (row[i+1] << 6));
+		if(first < last)
+			row[last] = static_cast<uchar>(row[last] >> 2);
+	}
+	--col_count;
+}
+
+void cvutil::RouteMatrix::backtrack(int col, std::vector<int>& seam) const
+{
+	// The first row has no predecessors, its cells are not read
+	seam.resize(static_cast<size_t>(row_count));
+	for(int r = row_count-1; r > 0; --r)
+	{
+		seam[static_cast<size_t>(r)] = col;
+		col += route_at(ptr(r), col);
+	}
+	if(row_count > 0)
+		seam[0] = col;
+}
@@ -0,0 +1,135 @@
+#ifndef ROUTE_MATRIX_H
+#define ROUTE_MATRIX_H
+
+#include "opencv2/core/core.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief pack_routes Packs column offsets -1, 0 and 1 into 2 bits per cell, as two's complement codes 3, 0 and 1.
+	 * Cell c lives in bits 2 * (c % 4) of byte c / 4. Runs 64 cells per SSE2 step, the rest with scalar code.
+	 * @param offsets The offsets of the cells [begin, end), indexed by column.
+	 * @param packed The packed row, indexed by byte.
+	 * @param begin The first cell, a multiple of 4.
+	 * @param end The cell after the last one. Unless it is a multiple of 4 the rest of its byte is overwritten.
+	 */
+	void pack_routes(const signed char* offsets, uchar* packed, int begin, int end);
+
+	/**
+	 * @brief route_at Unpacks the column offset of one cell of a row packed by pack_routes.
+	 */
+	inline int route_at(const uchar* packed, int c)
+	{
+		return (((packed[c / 4] >> (2 * (c % 4))) & 3) ^ 2) - 2;
+	}
+
+	/**
+	 * @brief The RouteMatrix class The column offsets of a seam search, packed to 2 bits per cell like pack_routes does.
+	 * A byte per cell needs as much write bandwidth as the energy map needs read bandwidth, 2 bits cut that to a quarter.
+	 * Rows start at 64 byte boundaries, so the row blocks of different threads do not share a byte, nor a cache line,
+	 * as long as they start at multiples of block_cells columns (see block_begin).
+	 */
+	class RouteMatrix
+	{
+	public:
+		static constexpr int block_cells = 256;	// Cells of one cache line
+
+		RouteMatrix() = default;
+
+		/**
+		 * @brief RouteMatrix Copies the cells into buffers of the used size.
+		 * @param other The matrix that is copied.
+		 */
+		RouteMatrix(const RouteMatrix& other);
+		RouteMatrix(RouteMatrix&& other) = default;
+		RouteMatrix& operator=(const RouteMatrix& other);
+		RouteMatrix& operator=(RouteMatrix&& other) = default;
+
+		static constexpr int byte_cells = 4;	// Cells of one packed byte
+
+		/**
+		 * @brief block_begin The first column of the block of thread t, rounded down to a multiple of cells.
+		 * Blocks of byte_cells never write the same byte, blocks of block_cells never share a cache line either.
+		 * @param cols The number of columns.
+		 * @param t The index of the thread, t == count gives cols.
+		 * @param count The number of threads.
+		 * @param cells The alignment, a multiple of byte_cells.
+		 */
+		static int block_begin(int cols, int t, int count, int cells = block_cells);
+
+		/**
+		 * @brief reserve Allocates the buffer for images of the given size in any orientation.
+		 * @param size The largest image size that will be searched.
+		 */
+		void reserve(cv::Size size);
+
+		/**
+		 * @brief create Sets the size, reusing the buffer if it is large enough. The cells are undefined afterwards.
+		 * @param rows The number of rows.
+		 * @param cols The number of columns.
+		 */
+		void create(int rows, int cols);
+
+		/**
+		 * @brief release Sets the size to 0, the buffer is kept.
+		 */
+		void release();
+
+		bool empty() const;
+		int rows() const;
+		int cols() const;
+
+		/**
+		 * @brief step The bytes between two rows, a multiple of 64.
+		 */
+		size_t step() const;
+
+		/**
+		 * @brief bytes The bytes of all rows.
+		 */
+		size_t bytes() const;
+
+		/**
+		 * @brief ptr The packed cells of a row.
+		 */
+		uchar* ptr(int r);
+		const uchar* ptr(int r) const;
+
+		/**
+		 * @brief at The column offset of a cell.
+		 */
+		int at(int r, int c) const;
+
+		/**
+		 * @brief set Changes the column offset of a cell.
+		 */
+		void set(int r, int c, int offset);
+
+		/**
+		 * @brief remove_vertical_seam Removes one cell per row, the cells right of it move left by one column.
+		 * @param seam The column of the removed cell for each row.
+		 */
+		void remove_vertical_seam(const std::vector<int>& seam);
+
+		/**
+		 * @brief backtrack Follows the offsets from a cell of the last row up to the first row.
+		 * @param col The column in the last row.
+		 * @param seam Receives the column for each row.
+		 */
+		void backtrack(int col, std::vector<int>& seam) const;
+
+	private:
+		static size_t row_step(int cols);
+
+		std::vector<uchar> buffer{};	// 63 bytes larger than the rows, they start at the first 64 byte boundary
+		uchar* data{nullptr};
+		int row_count{0};
+		int col_count{0};
+		size_t row_bytes{0};
+	};
+}
+
+#endif // ROUTE_MATRIX_H
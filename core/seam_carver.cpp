@@ -0,0 +1,390 @@
+#include "seam_carver.h"
+
+#include "cv_utility.h"
+
+#include <iostream>
+
+cvutil::SeamCarver::SeamCarver(const cv::Mat& image, EnergyMode mode, EnergyKernel kernel) :
+	SeamCarver{mode, kernel}
+{
+	if(image.type() != CV_8UC3 && image.type() != CV_8UC1)
+	{
+		std::cout << "ERROR: Image is neither 8UC3 nor 8UC1. Seam carving not supported!" << std::endl;
+		throw std::invalid_argument{"Seam carving applied to image with invalid type"};
+	}
+
+	// Forward energy is computed from the grayscale image by the finder itself
+	const auto backward = mode == EnergyMode::backward;
+	const auto functions = energy_functions(kernel);
+	const auto color = backward && functions.source_type == CV_8UC3;
+	if(color && image.channels() != 3)
+	{
+		std::cout << "ERROR: Energy kernel reads colors, image is 8UC1. Seam carving not supported!" << std::endl;
+		throw std::invalid_argument{"Seam carving applied to grayscale image with color energy"};
+	}
+
+	if(image.channels() == 3 && backward && kernel == EnergyKernel::sobel)
+		gray_energy(image, gray_buffers[0], energy_buffers[0]);
+	else
+	{
+		gray_buffers[0] = image.channels() == 3 ? grayscale(image) : image.clone();
+		if(color)
+			color_buffers[0] = image.clone();
+		if(backward)
+			energy_buffers[0] = functions.map(color ? color_buffers[0] : gray_buffers[0]);
+	}
+	index_buffers[0] = index_map(image.size());
+	original = image.size();
+
+	gray_buffers[1].create(image.cols, image.rows, CV_8UC1);
+	if(backward)
+		energy_buffers[1].create(image.cols, image.rows, CV_8UC1);
+	index_buffers[1].create(image.cols, image.rows, CV_32SC2);
+	if(color)
+		color_buffers[1].create(image.cols, image.rows, CV_8UC3);
+
+	working_gray = gray_buffers[0];
+	working_energy = energy_buffers[0];
+	working_index = index_buffers[0];
+	working_color = color_buffers[0];
+
+	searches[0].finder.reserve(image.size());
+	searches[1].finder.reserve(image.size());
+	const auto length = static_cast<size_t>(std::max(image.rows, image.cols));
+	for(auto& search : searches)
+		search.seam.reserve(length);
+	seam.reserve(length);
+	pixels.reserve(length);
+}
+
+cvutil::SeamCarver::SeamCarver(EnergyMode mode, EnergyKernel kernel) :
+	energy_mode{mode},
+	energy_kernel{kernel}
+{
+	for(auto& search : searches)
+	{
+		search.finder = BasicSeamFinder<MinSeam>{MinSeam{}, mode};
+		search.pyramid = PyramidSeamFinder{0, 4, mode};
+	}
+}
+
+cvutil::SeamCarver cvutil::SeamCarver::clone() const
+{
+	auto copy = SeamCarver{energy_mode, energy_kernel};
+
+	// Only the working copies are copied, orient() allocates the other orientation when it is needed
+	const auto current = transposed ? 1 : 0;
+	copy.gray_buffers[current] = working_gray.clone();
+	copy.energy_buffers[current] = working_energy.clone();
+	copy.index_buffers[current] = working_index.clone();
+	copy.color_buffers[current] = working_color.clone();
+	copy.mask_buffers[current] = working_mask.clone();
+	copy.working_gray = copy.gray_buffers[current];
+	copy.working_energy = copy.energy_buffers[current];
+	copy.working_index = copy.index_buffers[current];
+	copy.working_color = copy.color_buffers[current];
+	copy.working_mask = copy.mask_buffers[current];
+	copy.transposed = transposed;
+	copy.original = original;
+	copy.protected_pixels = protected_pixels;
+	copy.removed_pixels = removed_pixels;
+
+	for(int i = 0; i < 2; ++i)
+		copy.searches[i] = searches[i];
+	copy.seam = seam;
+	copy.pixels = pixels;
+	return copy;
+}
+
+void cvutil::SeamCarver::compact()
+{
+	const auto current = transposed ? 1 : 0;
+	auto shrink = [current] (cv::Mat& working, cv::Mat (&buffers)[2]) {
+		buffers[current] = working.clone();
+		buffers[1 - current].release();
+		working = buffers[current];
+	};
+	shrink(working_gray, gray_buffers);
+	shrink(working_energy, energy_buffers);
+	shrink(working_color, color_buffers);
+	shrink(working_mask, mask_buffers);
+
+	// Without the index map the removed seams are not projected to the original image
+	working_index.release();
+	index_buffers[0].release();
+	index_buffers[1].release();
+	pixels = std::vector<cv::Point>{};
+
+	// The seams found for the current image stay valid, the finders restart on the next search
+	for(auto& search : searches)
+	{
+		search.finder = BasicSeamFinder<MinSeam>{MinSeam{}, energy_mode};
+		search.pyramid = PyramidSeamFinder{search.pyramid.levels(), search.pyramid.band(), energy_mode};
+		search.follows = false;
+	}
+}
+
+cvutil::EnergyMode cvutil::SeamCarver::mode() const
+{
+	return energy_mode;
+}
+
+cvutil::EnergyKernel cvutil::SeamCarver::kernel() const
+{
+	return energy_kernel;
+}
+
+void cvutil::SeamCarver::coarse_to_fine(int levels, int band)
+{
+	for(auto& search : searches)
+	{
+		search.pyramid = PyramidSeamFinder{levels, band, energy_mode};
+		search.pyramid.reserve(original);
+		search.finder.reset();
+		search.follows = false;
+		search.found = false;
+	}
+}
+
+void cvutil::SeamCarver::set_masks(const cv::Mat& protect, const cv::Mat& remove)
+{
+	for(const auto mask : {&protect, &remove})
+	{
+		if(!mask->empty() && (mask->type() != CV_8UC1 || mask->size() != original))
+		{
+			std::cout << "ERROR: Mask is not 8UC1 or does not have the size of the original image. Seam carving not supported!" << std::endl;
+			throw std::invalid_argument{"Seam carving applied to invalid mask"};
+		}
+	}
+
+	clear_masks();
+	if(protect.empty() && remove.empty())
+		return;
+	if(working_index.empty())
+	{
+		std::cout << "ERROR: Carver was compacted and has no index map. Seam masks not supported!" << std::endl;
+		throw std::invalid_argument{"Seam masks applied to compacted carver"};
+	}
+	for(auto& search : searches)
+	{
+		search.follows = false;
+		search.found = false;
+	}
+
+	// Both orientations get their buffer of the original size, so that orient() does not allocate while carving
+	if(mask_buffers[0].rows < original.height || mask_buffers[0].cols < original.width)
+		mask_buffers[0].create(original.height, original.width, CV_8UC1);
+	if(mask_buffers[1].rows < original.width || mask_buffers[1].cols < original.height)
+		mask_buffers[1].create(original.width, original.height, CV_8UC1);
+
+	// The labels of the carved pixels, looked up through the index map in the current orientation
+	working_mask = mask_buffers[transposed ? 1 : 0](cv::Range(0, working_index.rows), cv::Range(0, working_index.cols));
+
+	for(int r = 0; r < working_index.rows; ++r)
+	{
+		const auto origin = working_index.ptr<cv::Vec<int, 2>>(r);
+		auto labels = working_mask.ptr<uchar>(r);
+		for(int c = 0; c < working_index.cols; ++c)
+		{
+			const auto& pixel = origin[c];
+			auto label = SeamMask::none;
+			if(!remove.empty() && remove.ptr<uchar>(pixel[0])[pixel[1]] != 0)
+			{
+				label = SeamMask::remove;
+				++removed_pixels;
+			}
+			else if(!protect.empty() && protect.ptr<uchar>(pixel[0])[pixel[1]] != 0)
+			{
+				label = SeamMask::protect;
+				++protected_pixels;
+			}
+			labels[c] = static_cast<uchar>(label);
+		}
+	}
+
+	if(protected_pixels == 0 && removed_pixels == 0)
+		working_mask = cv::Mat{};
+}
+
+void cvutil::SeamCarver::clear_masks()
+{
+	// The costs of the finders contain the old bias
+	if(!working_mask.empty())
+	{
+		for(auto& search : searches)
+		{
+			search.follows = false;
+			search.found = false;
+		}
+	}
+	working_mask = cv::Mat{};
+	protected_pixels = 0;
+	removed_pixels = 0;
+}
+
+int cvutil::SeamCarver::remaining() const
+{
+	return removed_pixels;
+}
+
+int cvutil::SeamCarver::remove_object(Orientation orientation)
+{
+	auto count = 0;
+	while(removed_pixels > 0)
+	{
+		const auto before = removed_pixels;
+		step(orientation);
+		++count;
+		if(removed_pixels == before)
+			break;
+	}
+	return count;
+}
+
+cv::Size cvutil::SeamCarver::size() const
+{
+	return transposed ? cv::Size(working_gray.rows, working_gray.cols) : working_gray.size();
+}
+
+const std::vector<int>& cvutil::SeamCarver::step(Orientation orientation)
+{
+	remove(find(orientation), orientation);
+	return seam;
+}
+
+const std::vector<int>& cvutil::SeamCarver::find(Orientation orientation)
+{
+	orient(orientation);
+	if(working_gray.cols <= 1)
+	{
+		std::cout << "ERROR: Image has only one or less pixels across the seam. Seam carving not supported!" << std::endl;
+		throw std::invalid_argument{"Seam carving applied to image that is too small"};
+	}
+
+	auto& search = searches[transposed ? 1 : 0];
+	if(!search.found)
+	{
+		// The finder continues from the last seam of this orientation if that one was removed last
+		const auto& searched = energy_mode == EnergyMode::forward ? working_gray : working_energy;
+		const auto coarse = search.pyramid.levels() > 0 && working_mask.empty();
+		const auto radius = energy_functions(energy_kernel).radius;
+		const auto& found = coarse ? search.pyramid.seam(searched)
+								   : search.follows ? search.finder.update(searched, seam, working_mask, radius) : search.finder.seam(searched, working_mask);
+		search.seam.assign(found.begin(), found.end());
+		search.cost = coarse ? search.pyramid.cost() : search.finder.cost();
+		search.found = true;
+	}
+	return search.seam;
+}
+
+int cvutil::SeamCarver::cost(Orientation orientation) const
+{
+	return searches[orientation == Orientation::horizontal ? 1 : 0].cost;
+}
+
+void cvutil::SeamCarver::remove(const std::vector<int>& removed, Orientation orientation)
+{
+	orient(orientation);
+	if(working_gray.cols <= 1 || static_cast<int>(removed.size()) != working_gray.rows)
+	{
+		std::cout << "ERROR: Seam does not match up with the image. Seam carving not supported!" << std::endl;
+		throw std::invalid_argument{"Seam carving applied to mismatching seam"};
+	}
+
+	// Only the finder whose seam is removed can continue, the image of the other orientation changed everywhere
+	const auto current = transposed ? 1 : 0;
+	searches[current].follows = searches[current].found && removed == searches[current].seam;
+	searches[1 - current].follows = false;
+	for(auto& search : searches)
+		search.found = false;
+
+	if(&removed != &seam)
+		seam.assign(removed.begin(), removed.end());
+	remove_vertical_seam<uchar>(working_gray, seam);
+	if(!working_index.empty())
+	{
+		cvutil::original_seam(working_index, seam, pixels);
+		remove_vertical_seam<cv::Vec<int, 2>>(working_index, seam);
+	}
+	if(!working_color.empty())
+		remove_vertical_seam<cv::Vec<uchar, 3>>(working_color, seam);
+	if(!working_energy.empty())
+		energy_functions(energy_kernel).update(working_energy, working_color.empty() ? working_gray : working_color, seam);
+
+	if(!working_mask.empty())
+	{
+		for(int r = 0; r < working_mask.rows; ++r)
+		{
+			const auto label = static_cast<SeamMask>(working_mask.ptr<uchar>(r)[seam[static_cast<size_t>(r)]]);
+			protected_pixels -= label == SeamMask::protect;
+			removed_pixels -= label == SeamMask::remove;
+		}
+		remove_vertical_seam<uchar>(working_mask, seam);
+
+		// Without labels the bias is 0 everywhere, so the finders can continue without the mask
+		if(protected_pixels == 0 && removed_pixels == 0)
+			working_mask = cv::Mat{};
+	}
+}
+
+void cvutil::SeamCarver::carve(int count, Orientation orientation)
+{
+	for(int s = 0; s < count; ++s)
+		step(orientation);
+}
+
+const std::vector<cv::Point>& cvutil::SeamCarver::original_seam() const
+{
+	return pixels;
+}
+
+cv::Mat cvutil::SeamCarver::gray() const
+{
+	return in_image_orientation(working_gray);
+}
+
+cv::Mat cvutil::SeamCarver::energy() const
+{
+	if(working_energy.empty())
+		return cvutil::energy(gray());
+	return in_image_orientation(working_energy);
+}
+
+cv::Mat cvutil::SeamCarver::index() const
+{
+	return in_image_orientation(working_index);
+}
+
+void cvutil::SeamCarver::orient(Orientation orientation)
+{
+	// Horizontal seams are vertical seams of the transposed working copies
+	if(transposed == (orientation == Orientation::horizontal))
+		return;
+
+	transposed = !transposed;
+	const auto target = transposed ? 1 : 0;
+	auto move = [target] (cv::Mat& working, cv::Mat (&buffers)[2]) {
+		if(working.empty())
+			return;
+		if(buffers[target].rows < working.cols || buffers[target].cols < working.rows)
+			buffers[target].create(working.cols, working.rows, working.type());
+		auto view = buffers[target](cv::Range(0, working.cols), cv::Range(0, working.rows));
+		cvutil::transpose(working, view);
+		working = view;
+	};
+	move(working_gray, gray_buffers);
+	move(working_energy, energy_buffers);
+	move(working_index, index_buffers);
+	move(working_color, color_buffers);
+	move(working_mask, mask_buffers);
+}
+
+cv::Mat cvutil::SeamCarver::in_image_orientation(const cv::Mat& working) const
+{
+	if(!transposed || working.empty())
+		return working;
+
+	auto result = cv::Mat{};
+	cvutil::transpose(working, result);
+	return result;
+}
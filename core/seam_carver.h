@@ -0,0 +1,224 @@
+#ifndef SEAM_CARVER_H
+#define SEAM_CARVER_H
+
+#include "energy_policy.h"
+#include "seam_finder.h"
+#include "seam_pyramid.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief The Orientation enum The direction of a seam.
+	 */
+	enum class Orientation
+	{
+		vertical,	// One pixel per row, removing it narrows the image
+		horizontal	// One pixel per column, removing it lowers the image
+	};
+
+	/**
+	 * @brief The SeamCarver class Workspace for carving many seams out of one image.
+	 * It owns the grayscale image, its energy map, an index map of original coordinates and the seam finder state.
+	 * All buffers are allocated once for the original size, in both orientations, and reused as the image shrinks,
+	 * so step() and carve() do not allocate memory after construction.
+	 * Horizontal seams are searched as vertical seams of a transposed working copy, which is only rebuilt when the orientation changes.
+	 * In forward energy mode the seams are searched on the grayscale image and no energy map is maintained.
+	 * In backward energy mode the energy map comes from one of the energy policies (see EnergyKernel). A kernel that reads
+	 * colors keeps a carved copy of the color image as well.
+	 * Each orientation keeps its own seam finder, which updates incrementally as long as only seams of its orientation are removed.
+	 * After coarse_to_fine() the seams are searched on a pyramid instead, see PyramidSeamFinder.
+	 * Protect and remove masks (see set_masks) are carved along with the grayscale image as one map of SeamMask labels,
+	 * which the seam finders add to the cumulative energy row by row.
+	 */
+	class SeamCarver
+	{
+	public:
+		/**
+		 * @brief SeamCarver Allocates all buffers and computes the grayscale image, energy map and index map.
+		 * @param image The 8UC3 or 8UC1 image to carve. It is not modified.
+		 * @param mode What the cumulative energy of the seams measures.
+		 * @param kernel The energy function of backward energy, forward energy ignores it.
+		 * @throws std::invalid_argument if the kernel reads colors and the image is 8UC1.
+		 */
+		explicit SeamCarver(const cv::Mat& image, EnergyMode mode = EnergyMode::backward, EnergyKernel kernel = EnergyKernel::sobel);
+
+		SeamCarver(const SeamCarver&) = delete;
+		SeamCarver(SeamCarver&&) = default;
+		SeamCarver& operator=(const SeamCarver&) = delete;
+		SeamCarver& operator=(SeamCarver&&) = default;
+
+		/**
+		 * @brief clone Deep copy of the carved state, including the seam finders and the seams found so far.
+		 * The copy allocates buffers of the carved size only, the buffers of the other orientation on first use.
+		 * @return The independent copy.
+		 */
+		SeamCarver clone() const;
+
+		/**
+		 * @brief compact Frees everything but the carved image and the seams already found, to keep many carver states at once.
+		 * The buffers shrink to the carved size of the current orientation. The index map and the finder states are dropped:
+		 * the following searches start from scratch, index() and original_seam() stay empty and set_masks() throws from now on.
+		 */
+		void compact();
+
+		/**
+		 * @brief mode What the cumulative energy of the seams measures.
+		 */
+		EnergyMode mode() const;
+
+		/**
+		 * @brief kernel The energy function of backward energy.
+		 */
+		EnergyKernel kernel() const;
+
+		/**
+		 * @brief coarse_to_fine Searches the following seams of both orientations with a PyramidSeamFinder.
+		 * Approximates the exact search for very large images, the incremental updates of the exact finders are dropped.
+		 * The pyramids are allocated for the original size here, so carving still does not allocate.
+		 * @param levels The number of halved levels below the full resolution, 0 returns to the exact search.
+		 * @param band The pixels searched to both sides of the refined seam, at least 1.
+		 */
+		void coarse_to_fine(int levels, int band);
+
+		/**
+		 * @brief set_masks Biases the following seams with masks of the original image. Seams avoid protected pixels and
+		 * take pixels to remove before any other, see SeamMask. While masks are set the seams are searched exactly, also after coarse_to_fine().
+		 * The masks are carved along with the image, once no masked pixel is left they are dropped.
+		 * @param protect 8UC1 mask of the original size, non-zero pixels are protected. May be empty.
+		 * @param remove 8UC1 mask of the original size, non-zero pixels are removed, also where they are protected. May be empty.
+		 * @throws std::invalid_argument if a mask is not 8UC1 or does not have the original size, or after compact().
+		 */
+		void set_masks(const cv::Mat& protect, const cv::Mat& remove);
+
+		/**
+		 * @brief clear_masks Drops the masks, the following seams depend on the energy only.
+		 */
+		void clear_masks();
+
+		/**
+		 * @brief remaining The pixels of the remove mask that the carved image still contains.
+		 */
+		int remaining() const;
+
+		/**
+		 * @brief remove_object Removes seams of one orientation until no pixel of the remove mask is left.
+		 * Stops early if a seam removes none of them, which happens when every way to them crosses more protected pixels.
+		 * @param orientation The direction of the seams.
+		 * @return The number of removed seams.
+		 */
+		int remove_object(Orientation orientation);
+
+		/**
+		 * @brief size The size of the carved image.
+		 */
+		cv::Size size() const;
+
+		/**
+		 * @brief step Finds and removes the next seam.
+		 * @param orientation The direction of the seam.
+		 * @return The seam in the coordinates of the image before the removal: the column for each row (vertical) or the row for each column (horizontal).
+		 * The reference stays valid until the next call.
+		 */
+		const std::vector<int>& step(Orientation orientation);
+
+		/**
+		 * @brief find Finds the next seam without removing it. Repeated calls return the same seam until the image changes.
+		 * @param orientation The direction of the seam.
+		 * @return The seam in the coordinates of the current image. The reference stays valid until the next call for this orientation.
+		 */
+		const std::vector<int>& find(Orientation orientation);
+
+		/**
+		 * @brief cost The cumulative energy of the last found seam of one orientation, see BasicSeamFinder::cost.
+		 * @param orientation The direction of the seam, find() or step() must have been called for it.
+		 */
+		int cost(Orientation orientation) const;
+
+		/**
+		 * @brief remove Removes a seam of the current image, usually one returned by find() on this carver or the one it was cloned from.
+		 * Removing the seam that find() returned lets the finder of that orientation continue incrementally.
+		 * @param seam The seam in the coordinates of the current image.
+		 * @param orientation The direction of the seam.
+		 */
+		void remove(const std::vector<int>& seam, Orientation orientation);
+
+		/**
+		 * @brief carve Removes count seams of one orientation.
+		 * @param count The number of seams.
+		 * @param orientation The direction of the seams.
+		 */
+		void carve(int count, Orientation orientation);
+
+		/**
+		 * @brief original_seam The pixels of the last removed seam in the coordinates of the original image.
+		 * @return Position (x = column, y = row) of every seam pixel.
+		 */
+		const std::vector<cv::Point>& original_seam() const;
+
+		/**
+		 * @brief gray The carved grayscale image. Copies if a transposed working copy is in use.
+		 */
+		cv::Mat gray() const;
+
+		/**
+		 * @brief energy The energy map of the carved image. Copies if a transposed working copy is in use, computes it in forward mode.
+		 */
+		cv::Mat energy() const;
+
+		/**
+		 * @brief index The index map (see index_map) of the carved image. Copies if a transposed working copy is in use.
+		 */
+		cv::Mat index() const;
+
+	private:
+		/**
+		 * @brief The Search struct Seam search state of one orientation.
+		 */
+		struct Search
+		{
+			BasicSeamFinder<MinSeam> finder;
+			PyramidSeamFinder pyramid;	// Replaces finder if it has levels
+			bool follows{false};	// The finder state belongs to the image before the last removal, which removed its seam
+			bool found{false};		// seam holds the next seam of the current image
+			std::vector<int> seam{};
+			int cost{0};
+		};
+
+		SeamCarver(EnergyMode mode, EnergyKernel kernel);
+
+		void orient(Orientation orientation);
+		cv::Mat in_image_orientation(const cv::Mat& working) const;
+
+		// Full size buffers, [0] in image orientation and [1] transposed
+		cv::Mat gray_buffers[2];
+		cv::Mat energy_buffers[2];
+		cv::Mat index_buffers[2];
+		cv::Mat color_buffers[2];	// Only for kernels that read colors
+		cv::Mat mask_buffers[2];	// Only while masks are set
+
+		// Carved working copies, views into the buffers of the current orientation
+		cv::Mat working_gray{};
+		cv::Mat working_energy{};
+		cv::Mat working_index{};
+		cv::Mat working_color{};
+		cv::Mat working_mask{};
+		bool transposed{false};
+
+		cv::Size original{};
+		int protected_pixels{0};	// Labels left in working_mask
+		int removed_pixels{0};
+
+		EnergyMode energy_mode;
+		EnergyKernel energy_kernel;
+		Search searches[2];	// [0] vertical, [1] horizontal
+
+		std::vector<int> seam{};	// The last removed seam
+		std::vector<cv::Point> pixels{};
+	};
+}
+
+#endif // SEAM_CARVER_H
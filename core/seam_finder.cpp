@@ -0,0 +1,249 @@
+#include "seam_finder.h"
+
+#include "cv_utility.h"
+#include "seam_kernel.h"
+#include "thread_pool.h"
+#include "tiled_rows.h"
+
+#include <iostream>
+#include <type_traits>
+
+template<typename Compare, typename Cost>
+cvutil::BasicSeamFinder<Compare, Cost>::BasicSeamFinder(Compare compare, EnergyMode mode)
+	: compare{std::move(compare)}, energy_mode{mode}
+{
+	// A default constructed SeamFinder searches minimal seams, like vertical_seam does
+	if constexpr(std::is_same_v<Compare, std::function<bool(int, int)>>)
+		if(!this->compare)
+			this->compare = std::less<int>();
+}
+
+template<typename Compare, typename Cost>
+cvutil::BasicSeamFinder<Compare, Cost>::BasicSeamFinder(const BasicSeamFinder& other)
+	: compare{other.compare}, energy_mode{other.energy_mode}, routes{other.routes}, path{other.path}
+{
+	// The cost matrix points into the buffer of other
+	if(other.costs.empty())
+		return;
+
+	reserve(other.costs.size());
+	costs = cv::Mat(other.costs.size(), cv::DataType<Cost>::type, cost_buffer.data());
+	other.costs.copyTo(costs);
+}
+
+template<typename Compare, typename Cost>
+cvutil::BasicSeamFinder<Compare, Cost>& cvutil::BasicSeamFinder<Compare, Cost>::operator=(const BasicSeamFinder& other)
+{
+	return *this = BasicSeamFinder(other);
+}
+
+template<typename Compare, typename Cost>
+cvutil::EnergyMode cvutil::BasicSeamFinder<Compare, Cost>::mode() const
+{
+	return energy_mode;
+}
+
+template<typename Compare, typename Cost>
+void cvutil::BasicSeamFinder<Compare, Cost>::reserve(cv::Size size)
+{
+	const auto area = static_cast<size_t>(size.area());
+	if(cost_buffer.size() < area)
+		cost_buffer.resize(area);
+	routes.reserve(size);
+	tiles.reserve(thread_pool().size(), std::max(size.width, size.height));
+
+	// At most every other column changes, and a seam has one entry per row
+	const auto length = static_cast<size_t>(std::max(size.width, size.height));
+	changed.reserve(length);
+	pending.reserve(length);
+	path.reserve(length);
+}
+
+template<typename Compare, typename Cost>
+const std::vector<int>& cvutil::BasicSeamFinder<Compare, Cost>::seam(const cv::Mat& image, const cv::Mat& mask)
+{
+	if(image.type() != CV_8UC1)
+	{
+		std::cout << "ERROR: Image has more than one channel or a depth >8 bits. Seam finding not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical seam finding applied to image with invalid type"};
+	}
+	if(image.cols <= 1)
+	{
+		std::cout << "ERROR: Image has only one or less columns. Seam finding not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical seam finding applied to image with too few columns"};
+	}
+	if(!mask.empty() && (mask.type() != CV_8UC1 || mask.size() != image.size()))
+	{
+		std::cout << "ERROR: Mask does not match up with the image. Seam finding not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical seam finding applied to mismatching image and mask"};
+	}
+
+	reserve(image.size());
+	costs = cv::Mat(image.size(), cv::DataType<Cost>::type, cost_buffer.data());
+	routes.create(image.rows, image.cols);
+
+	// Initialize with first row of the image
+	const auto forward = energy_mode == EnergyMode::forward;
+	for(int c = 0; c < image.cols; ++c)
+		costs.at<Cost>(0, c) = static_cast<Cost>(forward ? kernel::forward_top(image.ptr<uchar>(0), c, image.cols) : image.at<uchar>(0, c));
+	const auto masked = !mask.empty();
+	if(masked)
+		kernel::bias_row(mask.ptr<uchar>(0), costs.ptr<Cost>(0), 0, image.cols, compare);
+
+	// Multithreading, one block of columns per thread and a barrier after every band of rows (see tiled_rows).
+	// The last row of a band goes straight into the cost matrix, update() needs the own blocks of the other rows as well.
+	tiled_rows<Cost>(1, image.rows, image.cols, tiles, costs.ptr<Cost>(0),
+		[this] (int, int r) { return costs.ptr<Cost>(r); },
+		[this, &image, &mask, forward, masked] (const TileRow<Cost>& tile) {
+			// MinSeam on int costs runs the SIMD kernels, everything else an inlined scalar loop
+			const auto r = tile.row;
+			if(forward)
+				kernel::forward_row(tile.prev, image.ptr<uchar>(r-1), image.ptr<uchar>(r), tile.cur, tile.offsets, tile.begin, tile.finish, image.cols, compare);
+			else
+				kernel::relax_row(tile.prev, image.ptr<uchar>(r), tile.cur, tile.offsets, tile.begin, tile.finish, image.cols, compare);
+			if(masked)
+				kernel::bias_row(mask.ptr<uchar>(r), tile.cur, tile.begin, tile.finish, compare);
+			pack_routes(tile.offsets, routes.ptr(r), tile.start, tile.end);
+
+			const auto row = costs.ptr<Cost>(r);
+			if(tile.cur != row)
+				std::copy(tile.cur + tile.start, tile.cur + tile.end, row + tile.start);
+		});
+
+	return backtrack();
+}
+
+template<typename Compare, typename Cost>
+const std::vector<int>& cvutil::BasicSeamFinder<Compare, Cost>::update(const cv::Mat& image, const std::vector<int>& removed, const cv::Mat& mask, int radius)
+{
+	if(costs.empty())
+		return seam(image, mask);
+
+	if(image.type() != CV_8UC1)
+	{
+		std::cout << "ERROR: Image has more than one channel or a depth >8 bits. Seam finding not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical seam finding applied to image with invalid type"};
+	}
+	if(image.rows != costs.rows || image.cols != costs.cols-1 || image.cols <= 1)
+	{
+		std::cout << "ERROR: Energy map does not match up with the previous one minus one seam. Seam update not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical seam update applied to mismatching energy map"};
+	}
+	if(!mask.empty() && (mask.type() != CV_8UC1 || mask.size() != image.size()))
+	{
+		std::cout << "ERROR: Mask does not match up with the image. Seam update not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical seam update applied to mismatching image and mask"};
+	}
+
+	remove_vertical_seam<Cost>(costs, removed);
+	routes.remove_vertical_seam(removed);
+
+	const auto cols = image.cols;
+	const auto forward = energy_mode == EnergyMode::forward;
+	changed.clear();
+
+	for(int r = 0; r < image.rows; ++r)
+	{
+		// Cells whose energy may have changed. This band also contains every cell whose
+		// predecessors ended up on different sides of the removed seam.
+		// Forward costs only read this row and the one above, an energy of the given radius reads as many rows to both sides.
+		const auto reach = forward ? 1 : radius;
+		auto lowest = cols;
+		auto highest = 0;
+		for(int i = std::max(r - reach, 0); i <= std::min(forward ? r : r + reach, image.rows-1); ++i)
+		{
+			lowest = std::min(lowest, removed[static_cast<size_t>(i)]);
+			highest = std::max(highest, removed[static_cast<size_t>(i)]);
+		}
+		const auto band = Interval{std::max(lowest - reach, 0), std::min(highest + reach - 1, cols-1)};
+
+		// Merge the band with the cone below the cells that changed in the row above
+		pending.clear();
+		auto add = [this] (const Interval& interval) {
+			if(!pending.empty() && interval.first <= pending.back().second + 1)
+				pending.back().second = std::max(pending.back().second, interval.second);
+			else
+				pending.push_back(interval);
+		};
+		auto band_added = false;
+		for(const auto& interval : changed)
+		{
+			const auto cone = Interval{std::max(interval.first - 1, 0), std::min(interval.second + 1, cols-1)};
+			if(!band_added && band.first <= cone.first)
+			{
+				add(band);
+				band_added = true;
+			}
+			add(cone);
+		}
+		if(!band_added)
+			add(band);
+
+		// Recompute and remember which cells changed, the cone stops growing where nothing did
+		changed.clear();
+		const auto prev = r > 0 ? costs.ptr<Cost>(r-1) : nullptr;
+		const auto upper = r > 0 ? image.ptr<uchar>(r-1) : nullptr;
+		const auto local = image.ptr<uchar>(r);
+		const auto labels = mask.empty() ? nullptr : mask.ptr<uchar>(r);
+		auto cur = costs.ptr<Cost>(r);
+		for(const auto& interval : pending)
+		{
+			for(int c = interval.first; c <= interval.second; ++c)
+			{
+				const auto old = cur[c];
+				auto route = static_cast<signed char>(0);
+				if(r == 0)
+					cur[c] = static_cast<Cost>(forward ? kernel::forward_top(local, c, cols) : local[c]);
+				else if(forward)
+					cur[c] = kernel::forward_cell(prev, upper, local, cols, c, compare, route);
+				else
+					cur[c] = kernel::relax_cell(prev, cols, c, local[c], compare, route);
+				if(labels != nullptr && labels[c] != 0)
+					cur[c] = apply_bias<Cost>(cur[c], kernel::mask_cost(labels[c], compare));
+				routes.set(r, c, route);
+
+				if(cur[c] != old)
+				{
+					if(!changed.empty() && changed.back().second == c-1)
+						changed.back().second = c;
+					else
+						changed.emplace_back(c, c);
+				}
+			}
+		}
+	}
+
+	return backtrack();
+}
+
+template<typename Compare, typename Cost>
+Cost cvutil::BasicSeamFinder<Compare, Cost>::cost() const
+{
+	return costs.at<Cost>(costs.rows-1, path.back());
+}
+
+template<typename Compare, typename Cost>
+void cvutil::BasicSeamFinder<Compare, Cost>::reset()
+{
+	costs = cv::Mat{};
+	routes.release();
+}
+
+template<typename Compare, typename Cost>
+const std::vector<int>& cvutil::BasicSeamFinder<Compare, Cost>::backtrack()
+{
+	const auto last = costs.ptr<Cost>(costs.rows-1);
+	auto col = static_cast<int>(std::max_element(last, last + costs.cols, [this] (const Cost& a, const Cost& b) { return !compare(a,b); }) - last);
+
+	routes.backtrack(col, path);
+	return path;
+}
+
+// The specialized finders and the runtime one behind SeamFinder
+template class cvutil::BasicSeamFinder<cvutil::MinSeam, uint16_t>;
+template class cvutil::BasicSeamFinder<cvutil::MinSeam, int>;
+template class cvutil::BasicSeamFinder<cvutil::MinSeam, float>;
+template class cvutil::BasicSeamFinder<cvutil::MaxSeam, uint16_t>;
+template class cvutil::BasicSeamFinder<cvutil::MaxSeam, int>;
+template class cvutil::BasicSeamFinder<cvutil::MaxSeam, float>;
+template class cvutil::BasicSeamFinder<std::function<bool(int, int)>, int>;
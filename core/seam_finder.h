@@ -0,0 +1,120 @@
+#ifndef SEAM_FINDER_H
+#define SEAM_FINDER_H
+
+#include "route_matrix.h"
+#include "seam_policy.h"
+#include "tiled_rows.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace cvutil
+{
+	template<typename Compare, typename Cost = int>
+	/**
+	 * @brief The BasicSeamFinder class Finds vertical seams like vertical_seam, but keeps the cumulative energy and the route matrix between calls.
+	 * After a seam was removed, update() only recomputes the cells in the downward cone of the changed pixels
+	 * and stops widening the cone on every row where the recomputed values did not change.
+	 * The seams are identical to the ones of vertical_seam<Compare, Cost>, or in forward mode to vertical_seam(gray, EnergyMode::forward)
+	 * for MinSeam on int costs. Forward mode searches the grayscale image instead of an energy map.
+	 * Instantiated for MinSeam and MaxSeam with uint16_t, int and float costs, and for std::function<bool(int, int)> with int costs.
+	 * An optional mask of SeamMask labels biases every cell right after it is relaxed (see kernel::bias_row), so the
+	 * masks cost no pass over the image of their own.
+	 */
+	class BasicSeamFinder
+	{
+	public:
+		/**
+		 * @brief BasicSeamFinder Creates a finder without state.
+		 * @param compare The comparison that selects the preferred neighbour. An empty std::function selects std::less<int>.
+		 * @param mode What the cumulative energy measures, decides whether seam() and update() take energy maps or grayscale images.
+		 */
+		explicit BasicSeamFinder(Compare compare = Compare{}, EnergyMode mode = EnergyMode::backward);
+
+		/**
+		 * @brief BasicSeamFinder Copies the state into buffers of the used size, so the copy can update() independently.
+		 * @param other The finder that is copied.
+		 */
+		BasicSeamFinder(const BasicSeamFinder& other);
+		BasicSeamFinder(BasicSeamFinder&& other) = default;
+		BasicSeamFinder& operator=(const BasicSeamFinder& other);
+		BasicSeamFinder& operator=(BasicSeamFinder&& other) = default;
+
+		/**
+		 * @brief mode What the cumulative energy measures.
+		 */
+		EnergyMode mode() const;
+
+		/**
+		 * @brief reserve Allocates the buffers for images of up to size.area() pixels in any orientation.
+		 * Searches on images that fit do not allocate memory afterwards.
+		 * @param size The largest image size that will be searched.
+		 */
+		void reserve(cv::Size size);
+
+		/**
+		 * @brief seam Computes the cumulative energy of the whole image from scratch and returns the best vertical seam.
+		 * @param image The 8UC1 energy map, or the grayscale image in forward mode.
+		 * @param mask The 8UC1 SeamMask labels of the image, or empty for no bias.
+		 * @return The column coordinate for each row. The reference stays valid until the next call.
+		 */
+		const std::vector<int>& seam(const cv::Mat& image, const cv::Mat& mask = cv::Mat{});
+
+		/**
+		 * @brief update Returns the best vertical seam after one vertical seam was removed from the previous energy map.
+		 * Only the energy pixels within radius of the removed seam may differ from the previous map, as is the case after
+		 * update_vertical_energy for radius 1 or update_energy for the radius of its policy.
+		 * In forward mode the grayscale image must be the previous one with the seam removed by remove_vertical_seam.
+		 * The mask must be the previous one with the seam removed as well.
+		 * Falls back to seam() if the finder has no state yet.
+		 * @param image The 8UC1 energy map, or the grayscale image in forward mode, after the removal.
+		 * @param removed The seam that was removed from the previous map. May be the result of the previous call.
+		 * @param mask The 8UC1 SeamMask labels of the image, or empty for no bias.
+		 * @param radius The energy of a pixel depends on the (2 * radius + 1)^2 pixels around it, see EnergyKernel. Ignored in forward mode.
+		 * @return The column coordinate for each row. The reference stays valid until the next call.
+		 */
+		const std::vector<int>& update(const cv::Mat& image, const std::vector<int>& removed, const cv::Mat& mask = cv::Mat{}, int radius = 1);
+
+		/**
+		 * @brief cost The cumulative energy of the last seam, i.e. the sum of its energies or forward costs, plus the mask bias.
+		 */
+		Cost cost() const;
+
+		/**
+		 * @brief reset Drops the state, the next update() computes from scratch. The buffers are kept.
+		 */
+		void reset();
+
+	private:
+		using Interval = std::pair<int, int>;	// [first, second]
+
+		const std::vector<int>& backtrack();
+
+		Compare compare;
+		EnergyMode energy_mode;
+
+		// Storage for the cost matrix, reused as long as the image fits
+		std::vector<Cost> cost_buffer{};
+
+		cv::Mat costs{};		// Cumulative energy, one Cost per element
+		RouteMatrix routes{};	// Column offset to the predecessor, 2 bits per element
+		TileBuffers<Cost> tiles{};	// The private cost rows and route offsets of the threads
+
+		std::vector<int> path{};	// The last seam
+
+		// Column intervals of the previous row whose cost changed, and the intervals to recompute in the current row
+		std::vector<Interval> changed{};
+		std::vector<Interval> pending{};
+	};
+
+	/**
+	 * @brief SeamFinder Finder with a comparison chosen at runtime. std::less<int> runs the SIMD row kernel for full searches,
+	 * the cells of update() call the comparison through std::function.
+	 */
+	using SeamFinder = BasicSeamFinder<std::function<bool(int, int)>>;
+}
+
+#endif // SEAM_FINDER_H
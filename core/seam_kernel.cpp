@@ -0,0 +1,410 @@
+#include "seam_kernel.h"
+
+#include "simd.h"
+
+namespace
+{
+	using InteriorFunction = void (*)(const int*, const uchar*, int*, signed char*, int, int);
+	using ForwardFunction = void (*)(const int*, const uchar*, const uchar*, int*, signed char*, int, int);
+	using BiasFunction = void (*)(const uchar*, int*, int, int);
+
+	/**
+	 * @brief relax_border One cell of the minimal cumulative energy, with bounds checks for the border columns.
+	 */
+	inline void relax_border(const int* prev, const uchar* local, int* cur, signed char* route, int c, int cols)
+	{
+		auto value = prev[c];
+		signed char direction = 0;
+		if(c-1 >= 0 && prev[c-1] < value)
+		{
+			value = prev[c-1];
+			direction = -1;
+		}
+		if(c+1 < cols && prev[c+1] < value)
+		{
+			value = prev[c+1];
+			direction = 1;
+		}
+		cur[c] = value + local[c];
+		route[c] = direction;
+	}
+
+	/**
+	 * @brief interior_scalar Cells [begin, end), which must not touch the border.
+	 */
+	void interior_scalar(const int* prev, const uchar* local, int* cur, signed char* route, int begin, int end)
+	{
+		for(int c = begin; c < end; ++c)
+		{
+			const auto take_left = prev[c-1] < prev[c];
+			const auto centre = take_left ? prev[c-1] : prev[c];
+			const auto take_right = prev[c+1] < centre;
+			cur[c] = (take_right ? prev[c+1] : centre) + local[c];
+			route[c] = static_cast<signed char>(take_right ? 1 : -static_cast<int>(take_left));
+		}
+	}
+
+	/**
+	 * @brief forward_scalar Forward energy cells [begin, end), which must not touch the border.
+	 */
+	void forward_scalar(const int* prev, const uchar* above, const uchar* row, int* cur, signed char* route, int begin, int end)
+	{
+		for(int c = begin; c < end; ++c)
+		{
+			const int l = row[c-1];
+			const int u = row[c+1];
+			const int a = above[c];
+			const auto left = prev[c-1] + std::abs(a - l);
+			const auto right = prev[c+1] + std::abs(a - u);
+			const auto take_left = left < prev[c];
+			const auto centre = take_left ? left : prev[c];
+			const auto take_right = right < centre;
+			cur[c] = (take_right ? right : centre) + std::abs(u - l);
+			route[c] = static_cast<signed char>(take_right ? 1 : -static_cast<int>(take_left));
+		}
+	}
+
+	/**
+	 * @brief bias_scalar Mask bias of the cells [begin, end), only labelled cells saturate.
+	 */
+	void bias_scalar(const uchar* mask, int* cur, int begin, int end)
+	{
+		for(int c = begin; c < end; ++c)
+			if(mask[c] != 0)
+				cur[c] = cvutil::apply_bias<int>(cur[c], cvutil::kernel::mask_cost(mask[c], cvutil::MinSeam{}));
+	}
+
+#ifdef CVUTIL_SSE2
+	/**
+	 * @brief select_sse2 mask ? a : b per lane.
+	 */
+	inline __m128i select_sse2(__m128i mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	/**
+	 * @brief min4_sse2 Stores the minimum of the three candidates plus local for four cells, returns the offsets as 32 bit lanes.
+	 */
+	inline __m128i min4_sse2(__m128i left, __m128i up, __m128i right, __m128i local, int* cur)
+	{
+		const auto take_left = _mm_cmplt_epi32(left, up);
+		const auto centre = select_sse2(take_left, left, up);
+		const auto take_right = _mm_cmplt_epi32(right, centre);
+		const auto value = select_sse2(take_right, right, centre);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(cur), _mm_add_epi32(value, local));
+		// take_left is -1 where the left neighbour won
+		return select_sse2(take_right, _mm_set1_epi32(1), take_left);
+	}
+
+	/**
+	 * @brief relax4_sse2 Four cells starting at c, returns the offsets as 32 bit lanes.
+	 */
+	inline __m128i relax4_sse2(const int* prev, __m128i local, int* cur, int c)
+	{
+		const auto left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + c - 1));
+		const auto up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + c));
+		const auto right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + c + 1));
+		return min4_sse2(left, up, right, local, cur + c);
+	}
+
+	/**
+	 * @brief absdiff_sse2 |a - b| of 16 unsigned bytes.
+	 */
+	inline __m128i absdiff_sse2(__m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+	}
+
+	/**
+	 * @brief widen_sse2 Zero extends 16 bytes to four vectors of 32 bit lanes.
+	 */
+	inline void widen_sse2(__m128i bytes, __m128i (&lanes)[4])
+	{
+		const auto zero = _mm_setzero_si128();
+		const auto lo = _mm_unpacklo_epi8(bytes, zero);
+		const auto hi = _mm_unpackhi_epi8(bytes, zero);
+		lanes[0] = _mm_unpacklo_epi16(lo, zero);
+		lanes[1] = _mm_unpackhi_epi16(lo, zero);
+		lanes[2] = _mm_unpacklo_epi16(hi, zero);
+		lanes[3] = _mm_unpackhi_epi16(hi, zero);
+	}
+
+	void interior_sse2(const int* prev, const uchar* local, int* cur, signed char* route, int begin, int end)
+	{
+		const auto zero = _mm_setzero_si128();
+
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			const auto energy = _mm_loadu_si128(reinterpret_cast<const __m128i*>(local + c));
+			const auto energy_lo = _mm_unpacklo_epi8(energy, zero);
+			const auto energy_hi = _mm_unpackhi_epi8(energy, zero);
+
+			const auto d0 = relax4_sse2(prev, _mm_unpacklo_epi16(energy_lo, zero), cur, c);
+			const auto d1 = relax4_sse2(prev, _mm_unpackhi_epi16(energy_lo, zero), cur, c + 4);
+			const auto d2 = relax4_sse2(prev, _mm_unpacklo_epi16(energy_hi, zero), cur, c + 8);
+			const auto d3 = relax4_sse2(prev, _mm_unpackhi_epi16(energy_hi, zero), cur, c + 12);
+
+			// Saturating packs keep -1, 0 and 1 intact
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(route + c), _mm_packs_epi16(_mm_packs_epi32(d0, d1), _mm_packs_epi32(d2, d3)));
+		}
+		interior_scalar(prev, local, cur, route, c, end);
+	}
+
+	void forward_sse2(const int* prev, const uchar* above, const uchar* row, int* cur, signed char* route, int begin, int end)
+	{
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			const auto l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + c - 1));
+			const auto u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + c + 1));
+			const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + c));
+
+			// The new horizontal edge is paid by every move, the new vertical edge only by the diagonal ones
+			__m128i up[4], dl[4], dr[4];
+			widen_sse2(absdiff_sse2(u, l), up);
+			widen_sse2(absdiff_sse2(a, l), dl);
+			widen_sse2(absdiff_sse2(a, u), dr);
+
+			__m128i d[4];
+			for(int i = 0; i < 4; ++i)
+			{
+				const auto offset = c + 4 * i;
+				const auto left = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + offset - 1)), dl[i]);
+				const auto centre = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + offset));
+				const auto right = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + offset + 1)), dr[i]);
+				d[i] = min4_sse2(left, centre, right, up[i], cur + offset);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(route + c), _mm_packs_epi16(_mm_packs_epi32(d[0], d[1]), _mm_packs_epi32(d[2], d[3])));
+		}
+		forward_scalar(prev, above, row, cur, route, c, end);
+	}
+
+	/**
+	 * @brief label_signs_sse2 +1 for protected, -1 for removed and 0 for all other cells of 16 labels.
+	 */
+	inline __m128i label_signs_sse2(__m128i labels)
+	{
+		const auto protect = _mm_set1_epi8(static_cast<char>(cvutil::SeamMask::protect));
+		const auto remove = _mm_set1_epi8(static_cast<char>(cvutil::SeamMask::remove));
+		return _mm_sub_epi8(_mm_cmpeq_epi8(labels, remove), _mm_cmpeq_epi8(labels, protect));
+	}
+
+	void bias_sse2(const uchar* mask, int* cur, int begin, int end)
+	{
+		const auto zero = _mm_setzero_si128();
+		const auto upper = _mm_set1_epi32(cvutil::mask_bound);
+		const auto lower = _mm_set1_epi32(-cvutil::mask_bound);
+
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			// Most blocks carry no label at all
+			const auto labels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + c));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(labels, zero)) == 0xFFFF)
+				continue;
+
+			// Sign extended to 32 bit lanes by unpacking with itself and shifting back arithmetically
+			const auto signs = label_signs_sse2(labels);
+			const __m128i words[2] = {_mm_srai_epi16(_mm_unpacklo_epi8(signs, signs), 8), _mm_srai_epi16(_mm_unpackhi_epi8(signs, signs), 8)};
+			for(int i = 0; i < 4; ++i)
+			{
+				const auto& word = words[i / 2];
+				const auto lanes = _mm_srai_epi32(i % 2 == 0 ? _mm_unpacklo_epi16(word, word) : _mm_unpackhi_epi16(word, word), 16);
+				const auto original = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + c + 4 * i));
+
+				auto value = _mm_add_epi32(original, _mm_slli_epi32(lanes, cvutil::mask_shift));
+				value = select_sse2(_mm_cmpgt_epi32(value, upper), upper, value);
+				value = select_sse2(_mm_cmplt_epi32(value, lower), lower, value);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(cur + c + 4 * i), select_sse2(_mm_cmpeq_epi32(lanes, zero), original, value));
+			}
+		}
+		bias_scalar(mask, cur, c, end);
+	}
+#endif
+
+#ifdef CVUTIL_AVX2
+	/**
+	 * @brief min8_avx2 Stores the minimum of the three candidates plus local for eight cells, returns the offsets as 32 bit lanes.
+	 */
+	CVUTIL_TARGET_AVX2
+	inline __m256i min8_avx2(__m256i left, __m256i up, __m256i right, __m256i local, int* cur)
+	{
+		const auto take_left = _mm256_cmpgt_epi32(up, left);
+		const auto centre = _mm256_blendv_epi8(up, left, take_left);
+		const auto take_right = _mm256_cmpgt_epi32(centre, right);
+		const auto value = _mm256_blendv_epi8(centre, right, take_right);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(cur), _mm256_add_epi32(value, local));
+		// take_left is -1 where the left neighbour won
+		return _mm256_blendv_epi8(take_left, _mm256_set1_epi32(1), take_right);
+	}
+
+	/**
+	 * @brief relax8_avx2 Eight cells starting at c, returns the offsets as 32 bit lanes.
+	 */
+	CVUTIL_TARGET_AVX2
+	inline __m256i relax8_avx2(const int* prev, const uchar* local, int* cur, int c)
+	{
+		const auto left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + c - 1));
+		const auto up = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + c));
+		const auto right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + c + 1));
+		const auto energy = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(local + c)));
+		return min8_avx2(left, up, right, energy, cur + c);
+	}
+
+	/**
+	 * @brief forward8_avx2 Eight forward energy cells starting at c, the costs are given as bytes in the low half of each vector.
+	 */
+	CVUTIL_TARGET_AVX2
+	inline __m256i forward8_avx2(const int* prev, __m128i up, __m128i dl, __m128i dr, int* cur, int c)
+	{
+		const auto left = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + c - 1)), _mm256_cvtepu8_epi32(dl));
+		const auto centre = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + c));
+		const auto right = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + c + 1)), _mm256_cvtepu8_epi32(dr));
+		return min8_avx2(left, centre, right, _mm256_cvtepu8_epi32(up), cur + c);
+	}
+
+	CVUTIL_TARGET_AVX2
+	void interior_avx2(const int* prev, const uchar* local, int* cur, signed char* route, int begin, int end)
+	{
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			const auto d0 = relax8_avx2(prev, local, cur, c);
+			const auto d1 = relax8_avx2(prev, local, cur, c + 8);
+
+			// Packing works per 128 bit lane, restore the column order before the final pack
+			const auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(d0, d1), 0xD8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(route + c), _mm_packs_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1)));
+		}
+		interior_scalar(prev, local, cur, route, c, end);
+	}
+
+	CVUTIL_TARGET_AVX2
+	void forward_avx2(const int* prev, const uchar* above, const uchar* row, int* cur, signed char* route, int begin, int end)
+	{
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			const auto l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + c - 1));
+			const auto u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + c + 1));
+			const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + c));
+			const auto up = _mm_or_si128(_mm_subs_epu8(u, l), _mm_subs_epu8(l, u));
+			const auto dl = _mm_or_si128(_mm_subs_epu8(a, l), _mm_subs_epu8(l, a));
+			const auto dr = _mm_or_si128(_mm_subs_epu8(a, u), _mm_subs_epu8(u, a));
+
+			const auto d0 = forward8_avx2(prev, up, dl, dr, cur, c);
+			const auto d1 = forward8_avx2(prev, _mm_srli_si128(up, 8), _mm_srli_si128(dl, 8), _mm_srli_si128(dr, 8), cur, c + 8);
+
+			const auto packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(d0, d1), 0xD8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(route + c), _mm_packs_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1)));
+		}
+		forward_scalar(prev, above, row, cur, route, c, end);
+	}
+
+	CVUTIL_TARGET_AVX2
+	void bias_avx2(const uchar* mask, int* cur, int begin, int end)
+	{
+		const auto zero = _mm_setzero_si128();
+		const auto upper = _mm256_set1_epi32(cvutil::mask_bound);
+		const auto lower = _mm256_set1_epi32(-cvutil::mask_bound);
+
+		int c = begin;
+		for(; c + 16 <= end; c += 16)
+		{
+			const auto labels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + c));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(labels, zero)) == 0xFFFF)
+				continue;
+
+			const auto signs = label_signs_sse2(labels);
+			for(int i = 0; i < 2; ++i)
+			{
+				const auto lanes = _mm256_cvtepi8_epi32(i == 0 ? signs : _mm_srli_si128(signs, 8));
+				const auto original = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + c + 8 * i));
+				const auto value = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(original, _mm256_slli_epi32(lanes, cvutil::mask_shift)), lower), upper);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(cur + c + 8 * i), _mm256_blendv_epi8(value, original, _mm256_cmpeq_epi32(lanes, _mm256_setzero_si256())));
+			}
+		}
+		bias_scalar(mask, cur, c, end);
+	}
+#endif
+
+	InteriorFunction select_interior()
+	{
+#ifdef CVUTIL_AVX2
+		if(cvutil::simd::has_avx2())
+			return interior_avx2;
+#endif
+#ifdef CVUTIL_SSE2
+		return interior_sse2;
+#else
+		return interior_scalar;
+#endif
+	}
+
+	ForwardFunction select_forward()
+	{
+#ifdef CVUTIL_AVX2
+		if(cvutil::simd::has_avx2())
+			return forward_avx2;
+#endif
+#ifdef CVUTIL_SSE2
+		return forward_sse2;
+#else
+		return forward_scalar;
+#endif
+	}
+
+	BiasFunction select_bias()
+	{
+#ifdef CVUTIL_AVX2
+		if(cvutil::simd::has_avx2())
+			return bias_avx2;
+#endif
+#ifdef CVUTIL_SSE2
+		return bias_sse2;
+#else
+		return bias_scalar;
+#endif
+	}
+}
+
+void cvutil::kernel::relax_row(const int* prev, const uchar* local, int* cur, signed char* route, int begin, int end, int cols)
+{
+	static const auto interior = select_interior();
+
+	// Only the first and last column need bounds checks
+	const auto interior_begin = std::max(begin, 1);
+	const auto interior_end = std::min(end, cols-1);
+
+	for(int c = begin; c < std::min(interior_begin, end); ++c)
+		relax_border(prev, local, cur, route, c, cols);
+	if(interior_begin < interior_end)
+		interior(prev, local, cur, route, interior_begin, interior_end);
+	for(int c = std::max(interior_end, interior_begin); c < end; ++c)
+		relax_border(prev, local, cur, route, c, cols);
+}
+
+void cvutil::kernel::forward_row(const int* prev, const uchar* above, const uchar* row, int* cur, signed char* route, int begin, int end, int cols)
+{
+	static const auto interior = select_forward();
+
+	const auto interior_begin = std::max(begin, 1);
+	const auto interior_end = std::min(end, cols-1);
+
+	for(int c = begin; c < std::min(interior_begin, end); ++c)
+		cur[c] = forward_cell(prev, above, row, cols, c, MinSeam{}, route[c]);
+	if(interior_begin < interior_end)
+		interior(prev, above, row, cur, route, interior_begin, interior_end);
+	for(int c = std::max(interior_end, interior_begin); c < end; ++c)
+		cur[c] = forward_cell(prev, above, row, cols, c, MinSeam{}, route[c]);
+}
+
+void cvutil::kernel::bias_row(const uchar* mask, int* cur, int begin, int end)
+{
+	static const auto bias = select_bias();
+	bias(mask, cur, begin, end);
+}
@@ -0,0 +1,274 @@
+#ifndef SEAM_KERNEL_H
+#define SEAM_KERNEL_H
+
+#include "seam_policy.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <type_traits>
+
+namespace cvutil::kernel
+{
+	/**
+	 * @brief relax_row Computes the columns [begin, end) of one row of the minimal cumulative energy.
+	 * cur[c] = min(prev[c-1], prev[c], prev[c+1]) + local[c] and route[c] receives the column offset of the minimum.
+	 * Ties prefer the centre over the left and the left over the right neighbour, exactly like vertical_seam with std::less<int>.
+	 * The interior is computed branchlessly with AVX2 or SSE2 (chosen once at runtime), the first and last column with scalar code.
+	 * @param prev The cumulative energy of the row above, cols values.
+	 * @param local The energy of this row, cols values.
+	 * @param cur Receives the cumulative energy of this row.
+	 * @param route Receives the offsets -1, 0 or 1 as packed bytes.
+	 * @param begin The first column to compute.
+	 * @param end The column after the last one to compute.
+	 * @param cols The number of columns of the rows.
+	 */
+	void relax_row(const int* prev, const uchar* local, int* cur, signed char* route, int begin, int end, int cols);
+
+	/**
+	 * @brief forward_row Computes the columns [begin, end) of one row of the minimal cumulative forward energy.
+	 * Removing the seam pixel c joins its neighbours l = row[c-1] and u = row[c+1] (clamped at the border) and, for a
+	 * diagonal move, one of them with a = above[c]. Every move costs |u-l|, the move from the left additionally |a-l| and
+	 * the move from the right |a-u|. Ties are resolved like relax_row, the interior runs the same SIMD selection.
+	 * @param prev The cumulative forward energy of the row above, cols values.
+	 * @param above The grayscale row above, cols values.
+	 * @param row The grayscale row, cols values.
+	 * @param cur Receives the cumulative forward energy of this row.
+	 * @param route Receives the offsets -1, 0 or 1 as packed bytes.
+	 * @param begin The first column to compute.
+	 * @param end The column after the last one to compute.
+	 * @param cols The number of columns of the rows.
+	 */
+	void forward_row(const int* prev, const uchar* above, const uchar* row, int* cur, signed char* route, int begin, int end, int cols);
+
+	/**
+	 * @brief bias_row Adds the mask bias to the columns [begin, end) of one row of the minimal cumulative energy.
+	 * Protected cells cost mask_bias more and cells to remove mask_bias less, saturating like apply_bias<int>.
+	 * Blocks of 16 cells without a label are skipped after one compare, so rows away from the masks are barely touched.
+	 * Runs with AVX2 or SSE2 like relax_row.
+	 * @param mask The SeamMask labels of this row, cols values.
+	 * @param cur The cumulative energy of this row, as computed by relax_row or forward_row.
+	 * @param begin The first column to bias.
+	 * @param end The column after the last one to bias.
+	 */
+	void bias_row(const uchar* mask, int* cur, int begin, int end);
+
+	/**
+	 * @brief forward_top The forward energy of a pixel in the first row, which only joins its left and right neighbour.
+	 * @param row The grayscale row, cols values.
+	 * @param c The column of the pixel.
+	 * @param cols The number of columns.
+	 * @return |row[c+1] - row[c-1]| with clamped columns.
+	 */
+	inline int forward_top(const uchar* row, int c, int cols)
+	{
+		return std::abs(static_cast<int>(row[std::min(c+1, cols-1)]) - static_cast<int>(row[std::max(c-1, 0)]));
+	}
+
+	template<typename Compare, typename Cost>
+	/**
+	 * @brief relax_cell Computes one cell of the cumulative energy with any comparison.
+	 * The centre is preferred unless compare(left, centre), the result of that unless compare(right, result).
+	 * @param prev The cumulative energy of the row above, cols values.
+	 * @param cols The number of columns.
+	 * @param c The column of the cell.
+	 * @param local The energy of the cell.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 * @param route Receives the column offset to the selected neighbour.
+	 * @return The cumulative energy of the cell.
+	 */
+	inline Cost relax_cell(const Cost* prev, int cols, int c, uchar local, const Compare& compare, signed char& route)
+	{
+		auto value = prev[c];
+		route = 0;
+		if(c-1 >= 0 && compare(prev[c-1], value))
+		{
+			value = prev[c-1];
+			route = -1;
+		}
+		if(c+1 < cols && compare(prev[c+1], value))
+		{
+			value = prev[c+1];
+			route = 1;
+		}
+		return accumulate<Cost>(value, local);
+	}
+
+	template<typename Compare, typename Cost>
+	/**
+	 * @brief forward_cell Computes one cell of the cumulative forward energy (see forward_row) with any comparison.
+	 * The diagonal costs are added to the neighbours before they are compared, the cost shared by all moves afterwards.
+	 * @param prev The cumulative forward energy of the row above, cols values.
+	 * @param above The grayscale row above, cols values.
+	 * @param row The grayscale row, cols values.
+	 * @param cols The number of columns.
+	 * @param c The column of the cell.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 * @param route Receives the column offset to the selected neighbour.
+	 * @return The cumulative forward energy of the cell.
+	 */
+	inline Cost forward_cell(const Cost* prev, const uchar* above, const uchar* row, int cols, int c, const Compare& compare, signed char& route)
+	{
+		const int l = row[std::max(c-1, 0)];
+		const int u = row[std::min(c+1, cols-1)];
+		const int a = above[c];
+
+		auto value = prev[c];
+		route = 0;
+		if(c-1 >= 0)
+		{
+			const auto left = accumulate<Cost>(prev[c-1], std::abs(a - l));
+			if(compare(left, value))
+			{
+				value = left;
+				route = -1;
+			}
+		}
+		if(c+1 < cols)
+		{
+			const auto right = accumulate<Cost>(prev[c+1], std::abs(a - u));
+			if(compare(right, value))
+			{
+				value = right;
+				route = 1;
+			}
+		}
+		return accumulate<Cost>(value, std::abs(u - l));
+	}
+
+	template<typename Compare, typename Cost>
+	/**
+	 * @brief relax_row Computes the columns [begin, end) of one row of the cumulative energy with any comparison and cost type.
+	 * MinSeam on int costs, also wrapped in a std::function<bool(int, int)> holding std::less<int>, uses the SIMD kernel above.
+	 * Every other combination is a scalar loop in which compile-time comparisons are inlined.
+	 * @param prev The cumulative energy of the row above, cols values.
+	 * @param local The energy of this row, cols values.
+	 * @param cur Receives the cumulative energy of this row.
+	 * @param route Receives the column offsets -1, 0 or 1.
+	 * @param begin The first column to compute.
+	 * @param end The column after the last one to compute.
+	 * @param cols The number of columns of the rows.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 */
+	void relax_row(const Cost* prev, const uchar* local, Cost* cur, signed char* route, int begin, int end, int cols, const Compare& compare)
+	{
+		if constexpr(std::is_same_v<Compare, MinSeam> && std::is_same_v<Cost, int>)
+		{
+			relax_row(prev, local, cur, route, begin, end, cols);
+			return;
+		}
+		else if constexpr(std::is_same_v<Compare, std::function<bool(int, int)>> && std::is_same_v<Cost, int>)
+		{
+			if(compare.template target<std::less<int>>() != nullptr)
+			{
+				relax_row(prev, local, cur, route, begin, end, cols);
+				return;
+			}
+		}
+
+		// Only the border columns need bounds checks, the interior selects without branches
+		const auto first = std::max(begin, 1);
+		const auto last = std::min(end, cols-1);
+		for(int c = begin; c < std::min(first, end); ++c)
+			cur[c] = relax_cell(prev, cols, c, local[c], compare, route[c]);
+		for(int c = first; c < last; ++c)
+		{
+			const auto left = prev[c-1];
+			const auto right = prev[c+1];
+			const auto take_left = compare(left, prev[c]);
+			const auto value = take_left ? left : prev[c];
+			const auto take_right = compare(right, value);
+			cur[c] = accumulate<Cost>(take_right ? right : value, local[c]);
+			route[c] = static_cast<signed char>(take_right ? 1 : (take_left ? -1 : 0));
+		}
+		for(int c = std::max(last, begin); c < end; ++c)
+			cur[c] = relax_cell(prev, cols, c, local[c], compare, route[c]);
+	}
+
+	template<typename Compare, typename Cost>
+	/**
+	 * @brief forward_row Computes the columns [begin, end) of one row of the cumulative forward energy with any comparison and cost type.
+	 * Dispatches like relax_row<Compare, Cost>: MinSeam on int costs runs the SIMD kernel, everything else forward_cell.
+	 * @param prev The cumulative forward energy of the row above, cols values.
+	 * @param above The grayscale row above, cols values.
+	 * @param row The grayscale row, cols values.
+	 * @param cur Receives the cumulative forward energy of this row.
+	 * @param route Receives the column offsets -1, 0 or 1.
+	 * @param begin The first column to compute.
+	 * @param end The column after the last one to compute.
+	 * @param cols The number of columns of the rows.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 */
+	void forward_row(const Cost* prev, const uchar* above, const uchar* row, Cost* cur, signed char* route, int begin, int end, int cols, const Compare& compare)
+	{
+		if constexpr(std::is_same_v<Compare, MinSeam> && std::is_same_v<Cost, int>)
+		{
+			forward_row(prev, above, row, cur, route, begin, end, cols);
+			return;
+		}
+		else if constexpr(std::is_same_v<Compare, std::function<bool(int, int)>> && std::is_same_v<Cost, int>)
+		{
+			if(compare.template target<std::less<int>>() != nullptr)
+			{
+				forward_row(prev, above, row, cur, route, begin, end, cols);
+				return;
+			}
+		}
+
+		for(int c = begin; c < end; ++c)
+			cur[c] = forward_cell(prev, above, row, cols, c, compare, route[c]);
+	}
+
+	template<typename Compare>
+	/**
+	 * @brief mask_cost The bias of one SeamMask label. Protected pixels move the cost away from the one the comparison
+	 * prefers, pixels to remove towards it, so MaxSeam searches are biased the other way round than MinSeam ones.
+	 * @param label The SeamMask label.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 * @return +-mask_bias or 0.
+	 */
+	inline int mask_cost(uchar label, const Compare& compare)
+	{
+		const auto bias = compare(0, 1) ? mask_bias : -mask_bias;
+		if(label == static_cast<uchar>(SeamMask::protect))
+			return bias;
+		if(label == static_cast<uchar>(SeamMask::remove))
+			return -bias;
+		return 0;
+	}
+
+	template<typename Compare, typename Cost>
+	/**
+	 * @brief bias_row Adds the mask bias to the columns [begin, end) of one row of the cumulative energy with any comparison and cost type.
+	 * Dispatches like relax_row<Compare, Cost>: MinSeam on int costs runs the SIMD kernel, everything else apply_bias per cell.
+	 * @param mask The SeamMask labels of this row, cols values.
+	 * @param cur The cumulative energy of this row.
+	 * @param begin The first column to bias.
+	 * @param end The column after the last one to bias.
+	 * @param compare The comparison that selects the preferred neighbour.
+	 */
+	void bias_row(const uchar* mask, Cost* cur, int begin, int end, const Compare& compare)
+	{
+		if constexpr(std::is_same_v<Compare, MinSeam> && std::is_same_v<Cost, int>)
+		{
+			bias_row(mask, cur, begin, end);
+			return;
+		}
+		else if constexpr(std::is_same_v<Compare, std::function<bool(int, int)>> && std::is_same_v<Cost, int>)
+		{
+			if(compare.template target<std::less<int>>() != nullptr)
+			{
+				bias_row(mask, cur, begin, end);
+				return;
+			}
+		}
+
+		for(int c = begin; c < end; ++c)
+			if(mask[c] != 0)
+				cur[c] = apply_bias<Cost>(cur[c], mask_cost(mask[c], compare));
+	}
+}
+
+#endif // SEAM_KERNEL_H
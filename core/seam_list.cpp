@@ -0,0 +1,289 @@
+#include "seam_list.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/*
+ * Binary format, all integers little endian:
+ *
+ *	offset	size	content
+ *	0		4		magic "SCSL"
+ *	4		1		format version (1)
+ *	5		3		reserved (0)
+ *	8		4		seam count n
+ *	12		8 * n	per seam: first position, number of positions (both 4 bytes)
+ *	12 + 8n	...		per seam: the steps between its positions, 2 bits each as packed by pack_routes,
+ *					the last byte of a seam is padded with zero bits
+ *
+ * The steps are the arena of the list as is, so loading and saving copy it without decoding.
+ */
+
+namespace
+{
+	const auto magic = std::array<char, 4>{{'S', 'C', 'S', 'L'}};
+	const auto version = uint8_t{1};
+	const auto header_size = 12;
+	const auto entry_size = 8;
+
+	void put_u32(uint8_t* out, uint32_t value)
+	{
+		for(int i = 0; i < 4; ++i)
+			out[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+
+	uint32_t get_u32(const uint8_t* in)
+	{
+		auto value = uint32_t{0};
+		for(int i = 0; i < 4; ++i)
+			value |= static_cast<uint32_t>(in[i]) << (8 * i);
+		return value;
+	}
+
+	[[noreturn]] void invalid_file(const std::string& reason)
+	{
+		std::cout << "ERROR: " << reason << ". Loading the seam list not supported!" << std::endl;
+		throw std::runtime_error{"Seam list file is invalid: " + reason};
+	}
+
+	/**
+	 * @brief byte_steps The sum of the 4 steps packed into each byte value.
+	 */
+	const std::array<int, 256>& byte_steps()
+	{
+		static const auto sums = [] {
+			auto table = std::array<int, 256>{};
+			for(int byte = 0; byte < 256; ++byte)
+				for(int i = 0; i < 4; ++i)
+					table[static_cast<size_t>(byte)] += (((byte >> (2 * i)) & 3) ^ 2) - 2;
+			return table;
+		}();
+		return sums;
+	}
+}
+
+cvutil::SeamList::const_iterator cvutil::SeamList::Seam::seek(int index) const
+{
+	if(index >= length)
+		return end();
+
+	// Whole bytes through the table, the rest step by step
+	const auto& sums = byte_steps();
+	auto position = start;
+	for(int i = 0; i < index / 4; ++i)
+		position += sums[steps[i]];
+	for(int i = index / 4 * 4; i < index; ++i)
+		position += route_at(steps, i);
+	return const_iterator{steps, index, length, position};
+}
+
+void cvutil::SeamList::Seam::decode(int* positions) const
+{
+	auto position = start;
+	positions[0] = position;
+
+	// Four positions per byte, the last byte may hold fewer steps
+	const auto count = length - 1;
+	auto i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		const int byte = steps[i / 4];
+		positions[i+1] = position += ((byte & 3) ^ 2) - 2;
+		positions[i+2] = position += (((byte >> 2) & 3) ^ 2) - 2;
+		positions[i+3] = position += (((byte >> 4) & 3) ^ 2) - 2;
+		positions[i+4] = position += (((byte >> 6) & 3) ^ 2) - 2;
+	}
+	for(; i < count; ++i)
+		positions[i+1] = position += route_at(steps, i);
+}
+
+std::vector<int> cvutil::SeamList::Seam::to_vector() const
+{
+	auto positions = std::vector<int>(static_cast<size_t>(length));
+	decode(positions.data());
+	return positions;
+}
+
+size_t cvutil::SeamList::step_bytes(int length)
+{
+	return static_cast<size_t>(length + 2) / 4;
+}
+
+void cvutil::SeamList::reserve(size_t seams, int length)
+{
+	entries.reserve(seams);
+	arena.reserve(seams * step_bytes(length));
+}
+
+void cvutil::SeamList::push_back(const std::vector<int>& seam)
+{
+	if(seam.empty() || seam.size() > static_cast<size_t>(INT32_MAX))
+	{
+		std::cout << "ERROR: Seam of " << seam.size() << " positions. Seam list not supported!" << std::endl;
+		throw std::invalid_argument{"Seam list applied to an empty seam"};
+	}
+
+	// Steps outside of -1 to 1 would alias other codes
+	const auto length = static_cast<int>(seam.size());
+	deltas.resize(seam.size());
+	for(int i = 0; i + 1 < length; ++i)
+	{
+		const auto step = seam[static_cast<size_t>(i+1)] - seam[static_cast<size_t>(i)];
+		if(step < -1 || step > 1 || seam[static_cast<size_t>(i+1)] < 0)
+		{
+			std::cout << "ERROR: Seam is not connected. Seam list not supported!" << std::endl;
+			throw std::invalid_argument{"Seam list applied to a seam that is not connected"};
+		}
+		deltas[static_cast<size_t>(i)] = static_cast<signed char>(step);
+	}
+	if(seam[0] < 0)
+	{
+		std::cout << "ERROR: Seam starts at a negative position. Seam list not supported!" << std::endl;
+		throw std::invalid_argument{"Seam list applied to a seam with negative positions"};
+	}
+
+	const auto offset = arena.size();
+	arena.resize(offset + step_bytes(length));
+	if(length > 1)
+		pack_routes(deltas.data(), arena.data() + offset, 0, length - 1);
+	entries.push_back(Entry{offset, seam[0], length});
+}
+
+void cvutil::SeamList::clear()
+{
+	entries.clear();
+	arena.clear();
+}
+
+bool cvutil::SeamList::empty() const
+{
+	return entries.empty();
+}
+
+size_t cvutil::SeamList::size() const
+{
+	return entries.size();
+}
+
+cvutil::SeamList::Seam cvutil::SeamList::operator[](size_t i) const
+{
+	const auto& entry = entries[i];
+	return Seam{arena.data() + entry.offset, entry.start, entry.length};
+}
+
+cvutil::SeamList::Seam cvutil::SeamList::back() const
+{
+	return (*this)[entries.size() - 1];
+}
+
+size_t cvutil::SeamList::bytes() const
+{
+	return arena.size() + entries.size() * sizeof(Entry);
+}
+
+void cvutil::SeamList::save(std::ostream& stream) const
+{
+	auto header = std::array<uint8_t, header_size>{};
+	std::copy(magic.begin(), magic.end(), header.begin());
+	header[4] = version;
+	put_u32(&header[8], static_cast<uint32_t>(entries.size()));
+	stream.write(reinterpret_cast<const char*>(header.data()), header_size);
+
+	auto table = std::vector<uint8_t>(entries.size() * entry_size);
+	for(size_t i = 0; i < entries.size(); ++i)
+	{
+		put_u32(&table[i * entry_size], static_cast<uint32_t>(entries[i].start));
+		put_u32(&table[i * entry_size + 4], static_cast<uint32_t>(entries[i].length));
+	}
+	stream.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size()));
+	stream.write(reinterpret_cast<const char*>(arena.data()), static_cast<std::streamsize>(arena.size()));
+
+	if(!stream)
+	{
+		std::cout << "ERROR: Writing the seam list failed." << std::endl;
+		throw std::runtime_error{"Seam list could not be written"};
+	}
+}
+
+void cvutil::SeamList::save(const std::string& path) const
+{
+	auto file = std::ofstream{path, std::ios::binary};
+	if(!file)
+	{
+		std::cout << "ERROR: Cannot open " << path << " for writing." << std::endl;
+		throw std::runtime_error{"Seam list file could not be opened: " + path};
+	}
+	save(file);
+}
+
+cvutil::SeamList cvutil::SeamList::load(std::istream& stream)
+{
+	auto header = std::array<uint8_t, header_size>{};
+	if(!stream.read(reinterpret_cast<char*>(header.data()), header_size))
+		invalid_file("Truncated header");
+	if(!std::equal(magic.begin(), magic.end(), header.begin()))
+		invalid_file("Not a seam list file");
+	if(header[4] != version)
+		invalid_file("Unknown format version");
+
+	// The table grows while it is read, so a corrupt count fails on the missing data instead of allocating it
+	const auto count = get_u32(&header[8]);
+	auto result = SeamList{};
+	auto total = size_t{0};
+	for(uint32_t i = 0; i < count; ++i)
+	{
+		auto entry = std::array<uint8_t, entry_size>{};
+		if(!stream.read(reinterpret_cast<char*>(entry.data()), entry_size))
+			invalid_file("Truncated seam table");
+		const auto start = get_u32(&entry[0]);
+		const auto length = get_u32(&entry[4]);
+		if(start > INT32_MAX || length == 0 || length > INT32_MAX)
+			invalid_file("Invalid seam size");
+		result.entries.push_back(Entry{total, static_cast<int>(start), static_cast<int>(length)});
+		total += step_bytes(static_cast<int>(length));
+	}
+
+	const auto chunk = size_t{1} << 20;
+	while(result.arena.size() < total)
+	{
+		// Never reads past the list, the stream may continue with other data
+		const auto offset = result.arena.size();
+		const auto bytes = std::min(chunk, total - offset);
+		result.arena.resize(offset + bytes);
+		if(!stream.read(reinterpret_cast<char*>(result.arena.data() + offset), static_cast<std::streamsize>(bytes)))
+			invalid_file("Truncated steps");
+	}
+
+	// The code 2 is no step, padding bits are zero and no position may become negative
+	for(const auto& entry : result.entries)
+	{
+		const auto steps = result.arena.data() + entry.offset;
+		auto position = entry.start;
+		for(int i = 0; i < entry.length - 1; ++i)
+		{
+			if(((steps[i / 4] >> (2 * (i % 4))) & 3) == 2)
+				invalid_file("Invalid step");
+			position += route_at(steps, i);
+			if(position < 0)
+				invalid_file("Negative position");
+		}
+		const auto used = (entry.length - 1) % 4;
+		if(used != 0 && (steps[(entry.length - 1) / 4] >> (2 * used)) != 0)
+			invalid_file("Invalid padding");
+	}
+	return result;
+}
+
+cvutil::SeamList cvutil::SeamList::load(const std::string& path)
+{
+	auto file = std::ifstream{path, std::ios::binary};
+	if(!file)
+	{
+		std::cout << "ERROR: Cannot open " << path << " for reading." << std::endl;
+		throw std::runtime_error{"Seam list file could not be opened: " + path};
+	}
+	return load(file);
+}
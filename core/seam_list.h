@@ -0,0 +1,219 @@
+#ifndef SEAM_LIST_H
+#define SEAM_LIST_H
+
+#include "route_matrix.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief The SeamList class A sequence of seams in one contiguous arena, delta encoded.
+	 * A seam moves at most one column (vertical) or row (horizontal) per step, so it is stored as its first coordinate
+	 * plus one 2 bit step of -1, 0 or +1 per further position, packed like pack_routes does. A seam of 1000 positions
+	 * takes 250 bytes instead of 4000 and all seams share one allocation. The seams may differ in length, e.g. when
+	 * vertical and horizontal seams are interleaved.
+	 */
+	class SeamList
+	{
+	public:
+		/**
+		 * @brief The const_iterator class Decodes the positions of one seam in order, one add per position.
+		 */
+		class const_iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = int;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const int*;
+			using reference = const int&;
+
+			const_iterator() = default;
+
+			reference operator*() const { return position; }
+			pointer operator->() const { return &position; }
+
+			const_iterator& operator++()
+			{
+				// The step into position index + 1, the last position has none
+				if(++index < length)
+					position += route_at(steps, index-1);
+				return *this;
+			}
+
+			const_iterator operator++(int)
+			{
+				auto previous = *this;
+				++*this;
+				return previous;
+			}
+
+			bool operator==(const const_iterator& other) const { return index == other.index && steps == other.steps; }
+			bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+		private:
+			friend class SeamList;
+			const_iterator(const uchar* steps, int index, int length, int position) :
+				steps{steps}, index{index}, length{length}, position{position}
+			{}
+
+			const uchar* steps{nullptr};
+			int index{0};
+			int length{0};
+			int position{0};
+		};
+
+		/**
+		 * @brief The Seam class A view of one seam of the list, valid until the list is modified.
+		 */
+		class Seam
+		{
+		public:
+			int size() const { return length; }
+			int front() const { return start; }
+			const_iterator begin() const { return const_iterator{steps, 0, length, start}; }
+			const_iterator end() const { return const_iterator{steps, length, length, 0}; }
+
+			/**
+			 * @brief seek An iterator at the position index, decoding 4 steps per byte up to it.
+			 * @param index The position, from 0 to size().
+			 */
+			const_iterator seek(int index) const;
+
+			/**
+			 * @brief decode Writes all positions.
+			 * @param positions Receives size() positions.
+			 */
+			void decode(int* positions) const;
+
+			/**
+			 * @brief to_vector The positions as a vector, like the seam searches return them.
+			 */
+			std::vector<int> to_vector() const;
+
+		private:
+			friend class SeamList;
+			Seam(const uchar* steps, int start, int length) :
+				steps{steps}, start{start}, length{length}
+			{}
+
+			const uchar* steps;
+			int start;
+			int length;
+		};
+
+		SeamList() = default;
+
+		/**
+		 * @brief reserve Allocates the arena for a number of seams of the given length.
+		 * @param seams The number of seams.
+		 * @param length The positions per seam.
+		 */
+		void reserve(size_t seams, int length);
+
+		/**
+		 * @brief push_back Appends a seam.
+		 * @param seam The positions, neighbouring ones differ by at most 1 and none is negative. May not be empty.
+		 * @throws std::invalid_argument if the seam is empty or not connected.
+		 */
+		void push_back(const std::vector<int>& seam);
+
+		void clear();
+		bool empty() const;
+		size_t size() const;
+
+		/**
+		 * @brief operator[] The seam at an index, in insertion order.
+		 */
+		Seam operator[](size_t i) const;
+		Seam back() const;
+
+		/**
+		 * @brief bytes The bytes of the arena and the per seam table, without unused capacity.
+		 */
+		size_t bytes() const;
+
+		/**
+		 * @brief The seam_iterator class Iterates the seams of the list as Seam views.
+		 */
+		class seam_iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Seam;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = Seam;
+
+			Seam operator*() const { return (*list)[i]; }
+			seam_iterator& operator++() { ++i; return *this; }
+			bool operator==(const seam_iterator& other) const { return i == other.i; }
+			bool operator!=(const seam_iterator& other) const { return i != other.i; }
+
+		private:
+			friend class SeamList;
+			seam_iterator(const SeamList* list, size_t i) :
+				list{list}, i{i}
+			{}
+
+			const SeamList* list;
+			size_t i;
+		};
+
+		seam_iterator begin() const { return seam_iterator{this, 0}; }
+		seam_iterator end() const { return seam_iterator{this, size()}; }
+
+		/**
+		 * @brief save Writes the seams in the binary format (see seam_list.cpp).
+		 * @param stream The binary output stream.
+		 */
+		void save(std::ostream& stream) const;
+
+		/**
+		 * @brief save Writes the seams to a file in the binary format.
+		 * @param path The file path.
+		 */
+		void save(const std::string& path) const;
+
+		/**
+		 * @brief load Reads seams written by save().
+		 * @param stream The binary input stream.
+		 * @return The seams.
+		 */
+		static SeamList load(std::istream& stream);
+
+		/**
+		 * @brief load Reads seams from a file written by save().
+		 * @param path The file path.
+		 * @return The seams.
+		 */
+		static SeamList load(const std::string& path);
+
+	private:
+		/**
+		 * @brief The Entry struct Where a seam lives in the arena.
+		 */
+		struct Entry
+		{
+			size_t offset;	// First byte of the steps
+			int start;		// First position
+			int length;		// Positions, one more than steps
+		};
+
+		static size_t step_bytes(int length);
+
+		std::vector<Entry> entries{};
+		std::vector<uchar> arena{};
+		std::vector<signed char> deltas{};	// Scratch row for packing
+	};
+}
+
+#endif // SEAM_LIST_H
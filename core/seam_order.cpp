@@ -0,0 +1,298 @@
+#include "seam_order.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+/*
+ * Binary format, all integers little endian:
+ *
+ *	offset	size	content
+ *	0		4		magic "SCOR"
+ *	4		1		format version (1)
+ *	5		1		orientation (0 vertical, 1 horizontal)
+ *	6		1		bits per iteration value
+ *	7		1		reserved (0)
+ *	8		4		image width
+ *	12		4		image height
+ *	16		4		seam count
+ *	20		...		iteration values of all pixels row by row, bits per value wide, least significant bit first,
+ *					the last byte is padded with zero bits
+ *
+ * Iteration values range from 0 to the seam count, so the bit width adapts to the number of seams: 100 seams need
+ * 7 bits per pixel, 1000 seams 10 bits.
+ */
+
+namespace
+{
+	const auto magic = std::array<char, 4>{{'S', 'C', 'O', 'R'}};
+	const auto version = uint8_t{1};
+	const auto header_size = 20;
+
+	void put_u32(uint8_t* out, uint32_t value)
+	{
+		for(int i = 0; i < 4; ++i)
+			out[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+
+	uint32_t get_u32(const uint8_t* in)
+	{
+		auto value = uint32_t{0};
+		for(int i = 0; i < 4; ++i)
+			value |= static_cast<uint32_t>(in[i]) << (8 * i);
+		return value;
+	}
+
+	/**
+	 * @brief bit_width The number of bits needed to store values from 0 to maximum.
+	 */
+	int bit_width(uint32_t maximum)
+	{
+		auto bits = 1;
+		while(bits < 32 && (maximum >> bits) != 0)
+			++bits;
+		return bits;
+	}
+
+	[[noreturn]] void invalid_file(const std::string& reason)
+	{
+		std::cout << "ERROR: " << reason << ". Loading the seam order not supported!" << std::endl;
+		throw std::runtime_error{"Seam order file is invalid: " + reason};
+	}
+}
+
+cvutil::SeamOrder::SeamOrder(const cv::Mat& image, int minimum, Orientation orientation, EnergyMode mode, EnergyKernel kernel,
+							 const std::function<bool(int)>& proceed) :
+	direction{orientation}
+{
+	const auto original = orientation == Orientation::vertical ? image.cols : image.rows;
+	if(minimum < 1 || minimum > original)
+	{
+		std::cout << "ERROR: Minimum size outside of the image size. Seam order not supported!" << std::endl;
+		throw std::invalid_argument{"Seam order applied with invalid minimum size"};
+	}
+
+	seam_count = original - minimum;
+	order = cv::Mat(image.size(), CV_32SC1, cv::Scalar(seam_count));
+
+	auto carver = SeamCarver{image, mode, kernel};
+	for(int i = 0; i < seam_count; ++i)
+	{
+		carver.step(orientation);
+		for(const auto& pixel : carver.original_seam())
+			order.at<int>(pixel) = i;
+
+		if(proceed && !proceed(i + 1))
+		{
+			seam_count = 0;
+			order.release();
+			return;
+		}
+	}
+}
+
+bool cvutil::SeamOrder::empty() const
+{
+	return order.empty();
+}
+
+cvutil::Orientation cvutil::SeamOrder::orientation() const
+{
+	return direction;
+}
+
+cv::Size cvutil::SeamOrder::size() const
+{
+	return order.size();
+}
+
+int cvutil::SeamOrder::seams() const
+{
+	return seam_count;
+}
+
+const cv::Mat& cvutil::SeamOrder::iterations() const
+{
+	return order;
+}
+
+void cvutil::SeamOrder::save(std::ostream& stream) const
+{
+	const auto bits = bit_width(static_cast<uint32_t>(seam_count));
+
+	auto header = std::array<uint8_t, header_size>{};
+	std::copy(magic.begin(), magic.end(), header.begin());
+	header[4] = version;
+	header[5] = direction == Orientation::vertical ? 0 : 1;
+	header[6] = static_cast<uint8_t>(bits);
+	header[7] = 0;
+	put_u32(&header[8], static_cast<uint32_t>(order.cols));
+	put_u32(&header[12], static_cast<uint32_t>(order.rows));
+	put_u32(&header[16], static_cast<uint32_t>(seam_count));
+	stream.write(reinterpret_cast<const char*>(header.data()), header_size);
+
+	// Values are streamed through a 64 bit accumulator, full bytes are flushed row by row
+	auto bytes = std::vector<uint8_t>{};
+	bytes.reserve(static_cast<size_t>(order.cols) * static_cast<size_t>(bits) / 8 + 8);
+	auto buffer = uint64_t{0};
+	auto buffered = 0;
+	for(int r = 0; r < order.rows; ++r)
+	{
+		const auto values = order.ptr<int>(r);
+		for(int c = 0; c < order.cols; ++c)
+		{
+			buffer |= static_cast<uint64_t>(static_cast<uint32_t>(values[c])) << buffered;
+			buffered += bits;
+			while(buffered >= 8)
+			{
+				bytes.push_back(static_cast<uint8_t>(buffer));
+				buffer >>= 8;
+				buffered -= 8;
+			}
+		}
+		stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		bytes.clear();
+	}
+	if(buffered > 0)
+	{
+		const auto last = static_cast<char>(buffer);
+		stream.write(&last, 1);
+	}
+
+	if(!stream)
+	{
+		std::cout << "ERROR: Writing the seam order failed." << std::endl;
+		throw std::runtime_error{"Seam order could not be written"};
+	}
+}
+
+void cvutil::SeamOrder::save(const std::string& path) const
+{
+	auto file = std::ofstream{path, std::ios::binary};
+	if(!file)
+	{
+		std::cout << "ERROR: Cannot open " << path << " for writing." << std::endl;
+		throw std::runtime_error{"Seam order file could not be opened: " + path};
+	}
+	save(file);
+}
+
+cvutil::SeamOrder cvutil::SeamOrder::load(std::istream& stream)
+{
+	auto header = std::array<uint8_t, header_size>{};
+	if(!stream.read(reinterpret_cast<char*>(header.data()), header_size))
+		invalid_file("Truncated header");
+	if(!std::equal(magic.begin(), magic.end(), header.begin()))
+		invalid_file("Not a seam order file");
+	if(header[4] != version)
+		invalid_file("Unknown format version");
+	if(header[5] > 1)
+		invalid_file("Unknown orientation");
+
+	const auto width = get_u32(&header[8]);
+	const auto height = get_u32(&header[12]);
+	const auto seam_count = get_u32(&header[16]);
+	const auto bits = static_cast<int>(header[6]);
+	const auto vertical = header[5] == 0;
+	const auto extent = vertical ? width : height;
+	if(width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX || seam_count >= extent)
+		invalid_file("Invalid size");
+	if(bits != bit_width(seam_count))
+		invalid_file("Invalid bit width");
+
+	// A forged header must not allocate the order before the stream proved to hold its data. Seekable streams are measured,
+	// others are read ahead in chunks, so the buffer only grows with the data that actually arrives.
+	auto remaining = (static_cast<uint64_t>(width) * height * static_cast<uint64_t>(bits) + 7) / 8;
+	auto bytes = std::vector<uint8_t>{};
+	auto available = size_t{0};
+	const auto position = stream.tellg();
+	if(position != std::streampos(-1) && stream.seekg(0, std::ios::end))
+	{
+		const auto end = stream.tellg();
+		if(!stream.seekg(position) || end < position || static_cast<uint64_t>(end - position) < remaining)
+			invalid_file("Truncated data");
+		bytes.resize(static_cast<size_t>(width) * static_cast<size_t>(bits) / 8 + 8);
+	}
+	else
+	{
+		stream.clear();
+		const auto chunk_size = uint64_t{1} << 20;
+		while(remaining > 0)
+		{
+			const auto chunk = static_cast<size_t>(std::min(remaining, chunk_size));
+			bytes.resize(available + chunk);
+			stream.read(reinterpret_cast<char*>(bytes.data() + available), static_cast<std::streamsize>(chunk));
+			const auto count = static_cast<size_t>(stream.gcount());
+			if(count == 0)
+				invalid_file("Truncated data");
+			available += count;
+			remaining -= count;
+		}
+	}
+
+	auto result = SeamOrder{};
+	result.direction = vertical ? Orientation::vertical : Orientation::horizontal;
+	result.seam_count = static_cast<int>(seam_count);
+	result.order.create(static_cast<int>(height), static_cast<int>(width), CV_32SC1);
+
+	const auto mask = (uint64_t{1} << bits) - 1;
+	auto buffer = uint64_t{0};
+	auto buffered = 0;
+	auto next = size_t{0};
+	for(int r = 0; r < result.order.rows; ++r)
+	{
+		auto values = result.order.ptr<int>(r);
+		for(int c = 0; c < result.order.cols; ++c)
+		{
+			while(buffered < bits)
+			{
+				if(next == available)
+				{
+					// Never reads past the order, the stream may continue with other data
+					const auto chunk = std::min<uint64_t>(remaining, bytes.size());
+					stream.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(chunk));
+					available = static_cast<size_t>(stream.gcount());
+					remaining -= available;
+					next = 0;
+					if(available == 0)
+						invalid_file("Truncated data");
+				}
+				buffer |= static_cast<uint64_t>(bytes[next++]) << buffered;
+				buffered += 8;
+			}
+			values[c] = static_cast<int>(buffer & mask);
+			buffer >>= bits;
+			buffered -= bits;
+		}
+	}
+
+	// Retargeting relies on every seam removing exactly one pixel per row (vertical) or column (horizontal)
+	auto seen = std::vector<int>(seam_count + 1);
+	const auto lines = vertical ? result.order.rows : result.order.cols;
+	for(int line = 0; line < lines; ++line)
+	{
+		std::fill(seen.begin(), seen.end(), 0);
+		for(int i = 0; i < static_cast<int>(extent); ++i)
+		{
+			const auto value = vertical ? result.order.at<int>(line, i) : result.order.at<int>(i, line);
+			if(value < 0 || value > static_cast<int>(seam_count) || (value < static_cast<int>(seam_count) && seen[static_cast<size_t>(value)]++ > 0))
+				invalid_file("Inconsistent iteration values");
+		}
+		if(std::find(seen.begin(), seen.end() - 1, 0) != seen.end() - 1)
+			invalid_file("Inconsistent iteration values");
+	}
+	return result;
+}
+
+cvutil::SeamOrder cvutil::SeamOrder::load(const std::string& path)
+{
+	auto file = std::ifstream{path, std::ios::binary};
+	if(!file)
+	{
+		std::cout << "ERROR: Cannot open " << path << " for reading." << std::endl;
+		throw std::runtime_error{"Seam order file could not be opened: " + path};
+	}
+	return load(file);
+}
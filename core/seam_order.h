@@ -0,0 +1,303 @@
+#ifndef SEAM_ORDER_H
+#define SEAM_ORDER_H
+
+#include "cv_utility.h"
+#include "seam_carver.h"
+#include "thread_pool.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief The SeamOrder class Records for every pixel of an image the iteration in which seam carving removed it.
+	 * The image is carved once down to a minimum width (vertical seams) or height (horizontal seams). Afterwards any size between
+	 * the minimum and the original is produced by retarget() in a single pass over the original image, without searching seams.
+	 * The same order also enlarges the image by up to seams() pixels: the pixels of the first k seams are duplicated, which is
+	 * seam insertion as described by Avidan and Shamir. Pixels that survive down to the minimum hold the iteration seams().
+	 */
+	class SeamOrder
+	{
+	public:
+		/**
+		 * @brief SeamOrder Creates an empty order, e.g. as target for load().
+		 */
+		SeamOrder() = default;
+
+		/**
+		 * @brief SeamOrder Carves the image down to the minimum size and records the removal iterations.
+		 * @param image The 8UC3 or 8UC1 image. It is not modified.
+		 * @param minimum The smallest width (vertical) or height (horizontal) that can be retargeted to, at least 1.
+		 * @param orientation The direction of the removed seams.
+		 * @param mode What the cumulative energy of the seams measures.
+		 * @param kernel The energy function of backward energy, forward energy ignores it.
+		 * @param proceed Called after every seam with the number of removed seams. Returning false stops the computation
+		 * and leaves the order empty(). May be empty.
+		 */
+		SeamOrder(const cv::Mat& image, int minimum, Orientation orientation = Orientation::vertical,
+				  EnergyMode mode = EnergyMode::backward, EnergyKernel kernel = EnergyKernel::sobel,
+				  const std::function<bool(int)>& proceed = {});
+
+		/**
+		 * @brief empty Whether the order was neither computed nor loaded.
+		 */
+		bool empty() const;
+
+		/**
+		 * @brief orientation The direction of the removed seams.
+		 */
+		Orientation orientation() const;
+
+		/**
+		 * @brief size The size of the original image.
+		 */
+		cv::Size size() const;
+
+		/**
+		 * @brief seams The number of recorded seams, retarget() accepts original extent - seams() up to original extent + seams().
+		 */
+		int seams() const;
+
+		/**
+		 * @brief iterations The removal iteration of every original pixel, CV_32SC1.
+		 */
+		const cv::Mat& iterations() const;
+
+		template<typename T>
+		/**
+		 * @brief retarget Removes or inserts the first seams of the order in one pass over the original image.
+		 * Shrinking is identical to carving the image seam by seam down to the requested extent. Enlarging by k puts the average
+		 * of every pixel of the first k seams and its right (vertical) or lower (horizontal) neighbour next to it.
+		 * @param image The original image, it is not modified. image.size() == size()
+		 * @param extent The width (vertical) or height (horizontal) of the result.
+		 * @return The carved image.
+		 */
+		cv::Mat retarget(const cv::Mat& image, int extent) const;
+
+		template<typename T>
+		/**
+		 * @brief retarget Like retarget(image, extent), but writes into an existing image to avoid allocations.
+		 * @param image The original image, it is not modified. image.size() == size()
+		 * @param extent The width (vertical) or height (horizontal) of the result.
+		 * @param carved Receives the carved image, reallocated only if its size or type differ. Must not share data with image.
+		 */
+		void retarget(const cv::Mat& image, int extent, cv::Mat& carved) const;
+
+		/**
+		 * @brief save Writes the order in the compact binary format (see seam_order.cpp).
+		 * @param stream The binary output stream.
+		 */
+		void save(std::ostream& stream) const;
+
+		/**
+		 * @brief save Writes the order to a file in the compact binary format.
+		 * @param path The file path.
+		 */
+		void save(const std::string& path) const;
+
+		/**
+		 * @brief load Reads an order written by save().
+		 * The order is only allocated once the stream holds all of its data: seekable streams are measured first, others are
+		 * read ahead in chunks. The stream is left behind the order.
+		 * @param stream The binary input stream.
+		 * @return The order.
+		 * @throws std::runtime_error if the data is invalid or truncated.
+		 */
+		static SeamOrder load(std::istream& stream);
+
+		/**
+		 * @brief load Reads an order from a file written by save().
+		 * @param path The file path.
+		 * @return The order.
+		 */
+		static SeamOrder load(const std::string& path);
+
+	private:
+		Orientation direction{Orientation::vertical};
+		int seam_count{0};
+		cv::Mat order{};	// CV_32SC1, removal iteration per original pixel
+	};
+
+	template<typename T>
+	cv::Mat SeamOrder::retarget(const cv::Mat& image, int extent) const
+	{
+		auto carved = cv::Mat{};
+		retarget<T>(image, extent, carved);
+		return carved;
+	}
+
+	template<typename T>
+	void SeamOrder::retarget(const cv::Mat& image, int extent, cv::Mat& carved) const
+	{
+		const auto vertical = direction == Orientation::vertical;
+		const auto original = vertical ? order.cols : order.rows;
+		if(image.size() != order.size() || extent < original - seam_count || extent > original + seam_count)
+		{
+			std::cout << "ERROR: Image or size does not match up with the seam order. Retargeting not supported!" << std::endl;
+			throw std::invalid_argument{"Retargeting applied to an image or size outside of the seam order"};
+		}
+
+		// Pixels removed in the first original - extent iterations are skipped, when enlarging the ones removed in the
+		// first extent - original iterations are doubled. Every seam has exactly one pixel per line, so every line fits.
+		const auto threshold = original - extent;
+		carved.create(vertical ? image.rows : extent, vertical ? extent : image.cols, image.type());
+
+		if(vertical)
+		{
+			// Multithreading, one block of rows per thread
+			thread_pool().parallel_for(0, image.rows, [this, &image, &carved, threshold] (int start, int end) {
+				for(int r = start; r < end; ++r)
+				{
+					const auto in = image.ptr<T>(r);
+					const auto removed = order.ptr<int>(r);
+					auto out = carved.ptr<T>(r);
+					for(int c = 0; c < image.cols; ++c)
+					{
+						if(removed[c] >= threshold)
+							*out++ = in[c];
+						if(removed[c] < -threshold)
+							*out++ = average(in[c], in[std::min(c+1, image.cols-1)]);
+					}
+				}
+			});
+		}
+		else
+		{
+			// Multithreading, one block of columns per thread. Every column moves its kept pixels up to the next free row.
+			thread_pool().parallel_for(0, image.cols, [this, &image, &carved, threshold] (int start, int end) {
+				auto next = std::vector<int>(static_cast<size_t>(end - start), 0);
+				for(int r = 0; r < image.rows; ++r)
+				{
+					const auto in = image.ptr<T>(r);
+					const auto below = image.ptr<T>(std::min(r+1, image.rows-1));
+					const auto removed = order.ptr<int>(r);
+					for(int c = start; c < end; ++c)
+					{
+						auto& row = next[static_cast<size_t>(c - start)];
+						if(removed[c] >= threshold)
+							carved.ptr<T>(row++)[c] = in[c];
+						if(removed[c] < -threshold)
+							carved.ptr<T>(row++)[c] = average(in[c], below[c]);
+					}
+				}
+			});
+		}
+	}
+
+	template<typename T>
+	/**
+	 * @brief retarget Changes width and height at once with a vertical and a horizontal seam order of the same image.
+	 * The width follows the vertical order exactly, like SeamOrder::retarget. Every column of the resized image then keeps
+	 * the size.height pixels that the horizontal order removes last, in their row order, or doubles the pixels that it removes
+	 * first when the height grows. This approximates carving both directions and is exact as long as one of the two sizes is
+	 * unchanged. Costs one gather pass and a selection per column.
+	 * @param image The original image, it is not modified.
+	 * @param columns The vertical seam order of image.
+	 * @param rows The horizontal seam order of image.
+	 * @param size The size of the result, within the range of both orders.
+	 * @param carved Receives the carved image, reallocated only if its size or type differ. Must not share data with image.
+	 */
+	void retarget(const cv::Mat& image, const SeamOrder& columns, const SeamOrder& rows, cv::Size size, cv::Mat& carved)
+	{
+		if(columns.orientation() != Orientation::vertical || rows.orientation() != Orientation::horizontal
+				|| columns.size() != image.size() || rows.size() != image.size()
+				|| std::abs(size.height - image.rows) > rows.seams())
+		{
+			std::cout << "ERROR: Seam orders do not match up with the image or size. Retargeting not supported!" << std::endl;
+			throw std::invalid_argument{"Retargeting applied to seam orders of a different image or size"};
+		}
+
+		if(size.height == image.rows)
+		{
+			columns.retarget<T>(image, size.width, carved);
+			return;
+		}
+
+		if(std::abs(size.width - image.cols) > columns.seams())
+		{
+			std::cout << "ERROR: Size does not match up with the seam orders. Retargeting not supported!" << std::endl;
+			throw std::invalid_argument{"Retargeting applied to a size outside of the seam orders"};
+		}
+
+		// Original column of every pixel of the resized width, times two, plus one for pixels inserted right of that column
+		auto source = cv::Mat(image.rows, size.width, CV_32SC1);
+		const auto threshold = image.cols - size.width;
+		thread_pool().parallel_for(0, image.rows, [&image, &columns, &source, threshold] (int start, int end) {
+			for(int r = start; r < end; ++r)
+			{
+				const auto removed = columns.iterations().ptr<int>(r);
+				auto out = source.ptr<int>(r);
+				for(int c = 0; c < image.cols; ++c)
+				{
+					if(removed[c] >= threshold)
+						*out++ = 2 * c;
+					if(removed[c] < -threshold)
+						*out++ = 2 * c + 1;
+				}
+			}
+		});
+		carved.create(size, image.type());
+
+		// Multithreading, one block of columns per thread
+		const auto removed = image.rows - size.height;
+		thread_pool().parallel_for(0, size.width, [&image, &rows, &source, &carved, removed] (int start, int end) {
+			auto pixel = [&image, &source] (int r, int c) {
+				const auto in = image.ptr<T>(r);
+				const auto s = source.ptr<int>(r)[c];
+				return s % 2 == 0 ? in[s / 2] : average(in[s / 2], in[std::min(s / 2 + 1, image.cols-1)]);
+			};
+			auto keys = std::vector<int>(static_cast<size_t>(image.rows));
+			auto sorted = std::vector<int>(static_cast<size_t>(image.rows));
+			for(int c = start; c < end; ++c)
+			{
+				for(int r = 0; r < image.rows; ++r)
+					keys[static_cast<size_t>(r)] = rows.iterations().ptr<int>(r)[source.ptr<int>(r)[c] / 2];
+
+				// Enlarging doubles the pixels with the -removed smallest keys, equal ones in row order. The keys of one
+				// column may repeat once the width changed, since its pixels come from different original columns.
+				auto out = 0;
+				if(removed < 0)
+				{
+					sorted = keys;
+					std::nth_element(sorted.begin(), sorted.begin() + (-removed - 1), sorted.end());
+					const auto threshold = sorted[static_cast<size_t>(-removed - 1)];
+					auto ties = static_cast<int>(std::count(sorted.begin(), sorted.begin() + (-removed), threshold));
+
+					for(int r = 0; r < image.rows; ++r)
+					{
+						const auto key = keys[static_cast<size_t>(r)];
+						const auto value = pixel(r, c);
+						carved.ptr<T>(out++)[c] = value;
+						if(key < threshold || (key == threshold && ties-- > 0))
+							carved.ptr<T>(out++)[c] = average(value, pixel(std::min(r+1, image.rows-1), c));
+					}
+					continue;
+				}
+
+				// Keys above the removed-th smallest one are kept, equal ones in row order until the column is full
+				sorted = keys;
+				std::nth_element(sorted.begin(), sorted.begin() + removed, sorted.end());
+				const auto threshold = sorted[static_cast<size_t>(removed)];
+				auto ties = static_cast<int>(std::count_if(sorted.begin() + removed, sorted.end(), [threshold] (int key) { return key == threshold; }));
+
+				for(int r = 0; r < image.rows; ++r)
+				{
+					const auto key = keys[static_cast<size_t>(r)];
+					if(key > threshold || (key == threshold && ties-- > 0))
+						carved.ptr<T>(out++)[c] = pixel(r, c);
+				}
+			}
+		});
+	}
+}
+
+#endif // SEAM_ORDER_H
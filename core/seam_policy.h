@@ -0,0 +1,86 @@
+#ifndef SEAM_POLICY_H
+#define SEAM_POLICY_H
+
+#include "opencv2/core/core.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+namespace cvutil
+{
+	/**
+	 * @brief MinSeam Comparison policy of the seam with minimal energy. Known at compile time, so the relax loops inline it.
+	 */
+	using MinSeam = std::less<>;
+
+	/**
+	 * @brief MaxSeam Comparison policy of the seam with maximal energy.
+	 */
+	using MaxSeam = std::greater<>;
+
+	/**
+	 * @brief The EnergyMode enum What the cumulative energy of a seam measures.
+	 */
+	enum class EnergyMode
+	{
+		backward,	// Sum of the energy map along the seam, the map is the input of the search
+		forward		// Sum of the gradients between the pixels that become neighbours by removing the seam, the grayscale image is the input
+	};
+
+	/**
+	 * @brief The SeamMask enum Labels of the mask that biases the seam search, one byte per pixel.
+	 */
+	enum class SeamMask : uchar
+	{
+		none,		// The energy alone decides
+		protect,	// Seams avoid the pixel, it costs mask_bias more
+		remove		// Seams take the pixel, it costs mask_bias less
+	};
+
+	constexpr int mask_shift = 20;
+	constexpr int mask_bias = 1 << mask_shift;	// Outweighs the energy of 4096 pixels of maximal energy
+	constexpr int mask_bound = 1 << 30;			// Biased int costs saturate at +-mask_bound
+
+	template<typename Cost>
+	/**
+	 * @brief accumulate Adds the energy or forward cost of a pixel to a cumulative energy.
+	 * uint16_t saturates at 65535, so it is exact only for cumulative energies below that (e.g. up to 257 rows).
+	 * int32_t and float are exact for every image OpenCV can hold.
+	 * @param cost The cumulative energy of the predecessor.
+	 * @param local The energy of the pixel, non-negative.
+	 * @return The cumulative energy of the pixel.
+	 */
+	inline Cost accumulate(Cost cost, int local)
+	{
+		if constexpr(std::is_same_v<Cost, uint16_t>)
+			return static_cast<uint16_t>(std::min<int>(cost + local, std::numeric_limits<uint16_t>::max()));
+		else
+			return static_cast<Cost>(cost + local);
+	}
+
+	template<typename Cost>
+	/**
+	 * @brief apply_bias Adds the bias of a masked pixel to a cumulative energy, saturating at the range of the cost type.
+	 * int32_t saturates at +-mask_bound, which leaves room for the energy of the rows below without overflow.
+	 * uint16_t saturates at 0 and 65535, float is exact. Without bias the cost is returned unchanged.
+	 * @param cost The cumulative energy of the pixel.
+	 * @param bias The bias, +-mask_bias or 0.
+	 * @return The biased cumulative energy.
+	 */
+	inline Cost apply_bias(Cost cost, int bias)
+	{
+		if(bias == 0)
+			return cost;
+		if constexpr(std::is_same_v<Cost, uint16_t>)
+			return static_cast<uint16_t>(std::clamp<int>(cost + bias, 0, std::numeric_limits<uint16_t>::max()));
+		else if constexpr(std::is_same_v<Cost, int>)
+			return std::clamp(cost + bias, -mask_bound, mask_bound);
+		else
+			return static_cast<Cost>(cost + bias);
+	}
+}
+
+#endif // SEAM_POLICY_H
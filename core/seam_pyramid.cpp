@@ -0,0 +1,222 @@
+#include "seam_pyramid.h"
+
+#include "seam_kernel.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+	/**
+	 * @brief halve Downsamples one level of the pyramid by two in both directions, odd sizes repeat the last row or column.
+	 * @param image The 8UC1 level.
+	 * @param half Receives the next level, of size ((cols+1)/2, (rows+1)/2).
+	 * @param mode Backward energy keeps the maximum of every 2x2 block, the grayscale image of forward energy the rounded mean.
+	 */
+	void halve(const cv::Mat& image, cv::Mat& half, cvutil::EnergyMode mode)
+	{
+		const auto forward = mode == cvutil::EnergyMode::forward;
+		cvutil::thread_pool().parallel_for(0, half.rows, [&image, &half, forward] (int start, int end) {
+			for(int r = start; r < end; ++r)
+			{
+				const auto top = image.ptr<uchar>(2*r);
+				const auto bottom = image.ptr<uchar>(std::min(2*r+1, image.rows-1));
+				auto out = half.ptr<uchar>(r);
+				for(int c = 0; c < half.cols; ++c)
+				{
+					const auto left = 2*c;
+					const auto right = std::min(2*c+1, image.cols-1);
+					if(forward)
+						out[c] = static_cast<uchar>((top[left] + top[right] + bottom[left] + bottom[right] + 2) / 4);
+					else
+						out[c] = std::max({top[left], top[right], bottom[left], bottom[right]});
+				}
+			}
+		});
+	}
+}
+
+cvutil::PyramidSeamFinder::PyramidSeamFinder(int levels, int band, EnergyMode mode) :
+	level_count{levels}, band_width{band}, energy_mode{mode}, coarsest{MinSeam{}, mode}
+{
+	if(levels < 0 || band < 1)
+	{
+		std::cout << "ERROR: Pyramid needs 0 or more levels and a band of at least 1 pixel. Pyramid seam finding not supported!" << std::endl;
+		throw std::invalid_argument{"Pyramid seam finding applied with invalid levels or band"};
+	}
+}
+
+cvutil::PyramidSeamFinder::PyramidSeamFinder(const PyramidSeamFinder& other) :
+	PyramidSeamFinder{other.level_count, other.band_width, other.energy_mode}
+{
+}
+
+cvutil::PyramidSeamFinder& cvutil::PyramidSeamFinder::operator=(const PyramidSeamFinder& other)
+{
+	return *this = PyramidSeamFinder(other);
+}
+
+void cvutil::PyramidSeamFinder::reserve(cv::Size size)
+{
+	// The halved levels have the same areas in both orientations
+	if(buffers.size() < static_cast<size_t>(level_count))
+		buffers.resize(static_cast<size_t>(level_count));
+	pyramid.reserve(static_cast<size_t>(level_count));
+	auto level = size;
+	for(int l = 0; l < level_count; ++l)
+	{
+		level = cv::Size((level.width + 1) / 2, (level.height + 1) / 2);
+		auto& buffer = buffers[static_cast<size_t>(l)];
+		if(buffer.size() < static_cast<size_t>(level.area()))
+			buffer.resize(static_cast<size_t>(level.area()));
+	}
+
+	// The coarsest level is largest in the orientation that runs out of columns first
+	auto coarsest_size = size;
+	for(int l = 0; l < level_count && (std::min(coarsest_size.width, coarsest_size.height) + 1) / 2 >= 4; ++l)
+		coarsest_size = cv::Size((coarsest_size.width + 1) / 2, (coarsest_size.height + 1) / 2);
+	coarsest.reserve(coarsest_size);
+
+	// Every row and column of the finest level, coarse and path swap their buffers between the levels
+	const auto length = static_cast<size_t>(std::max(size.width, size.height));
+	for(auto buffer : {&coarse, &path, &previous_costs, &current_costs})
+		buffer->reserve(length);
+	route_row.reserve(length);
+	bands.reserve(length);
+	routes.reserve(length * static_cast<size_t>(2 * band_width + 2));
+}
+
+int cvutil::PyramidSeamFinder::levels() const
+{
+	return level_count;
+}
+
+int cvutil::PyramidSeamFinder::band() const
+{
+	return band_width;
+}
+
+cvutil::EnergyMode cvutil::PyramidSeamFinder::mode() const
+{
+	return energy_mode;
+}
+
+const std::vector<int>& cvutil::PyramidSeamFinder::seam(const cv::Mat& image)
+{
+	if(image.type() != CV_8UC1)
+	{
+		std::cout << "ERROR: Image has more than one channel or a depth >8 bits. Seam finding not supported!" << std::endl;
+		throw std::invalid_argument{"Vertical seam finding applied to image with invalid type"};
+	}
+
+	// Halve while the next level keeps at least 4 columns
+	pyramid.clear();
+	auto level = image;
+	for(int l = 0; l < level_count && (level.cols + 1) / 2 >= 4; ++l)
+	{
+		const auto size = cv::Size((level.cols + 1) / 2, (level.rows + 1) / 2);
+		if(buffers.size() <= static_cast<size_t>(l))
+			buffers.emplace_back();
+		if(buffers[static_cast<size_t>(l)].size() < static_cast<size_t>(size.area()))
+			buffers[static_cast<size_t>(l)].resize(static_cast<size_t>(size.area()));
+
+		pyramid.emplace_back(size, CV_8UC1, buffers[static_cast<size_t>(l)].data());
+		halve(level, pyramid.back(), energy_mode);
+		level = pyramid.back();
+	}
+
+	// The coarsest level is searched completely
+	const auto& found = coarsest.seam(level);
+	cell_count = static_cast<long long>(level.rows) * level.cols;
+	if(pyramid.empty())
+	{
+		path.assign(found.begin(), found.end());
+		last_cost = coarsest.cost();
+		return path;
+	}
+
+	// Every finer level within the band around the doubled seam of the level below
+	coarse.assign(found.begin(), found.end());
+	for(auto l = static_cast<int>(pyramid.size()) - 1; l >= 0; --l)
+	{
+		refine(l == 0 ? image : pyramid[static_cast<size_t>(l-1)], coarse);
+		if(l > 0)
+			std::swap(coarse, path);
+	}
+	return path;
+}
+
+int cvutil::PyramidSeamFinder::cost() const
+{
+	return last_cost;
+}
+
+long long cvutil::PyramidSeamFinder::cells() const
+{
+	return cell_count;
+}
+
+void cvutil::PyramidSeamFinder::refine(const cv::Mat& image, const std::vector<int>& coarse)
+{
+	const auto cols = image.cols;
+	const auto stride = static_cast<size_t>(2 * band_width + 2);
+	const auto forward = energy_mode == EnergyMode::forward;
+	const auto unreachable = std::numeric_limits<int>::max() / 2;
+
+	previous_costs.resize(static_cast<size_t>(cols));
+	current_costs.resize(static_cast<size_t>(cols));
+	route_row.resize(static_cast<size_t>(cols));
+	bands.resize(static_cast<size_t>(image.rows));
+	routes.resize(static_cast<size_t>(image.rows) * stride);
+
+	for(int r = 0; r < image.rows; ++r)
+	{
+		// Both columns of the coarse seam pixel and band columns to each side
+		const auto centre = 2 * coarse[static_cast<size_t>(r / 2)];
+		const auto band = Interval{std::max(centre - band_width, 0), std::min(centre + 1 + band_width, cols-1)};
+		bands[static_cast<size_t>(r)] = band;
+
+		const auto row = image.ptr<uchar>(r);
+		if(r == 0)
+		{
+			for(int c = band.first; c <= band.second; ++c)
+			{
+				current_costs[static_cast<size_t>(c)] = forward ? kernel::forward_top(row, c, cols) : row[c];
+				route_row[static_cast<size_t>(c)] = 0;
+			}
+		}
+		else
+		{
+			std::swap(previous_costs, current_costs);
+
+			// Predecessors outside the band of the row above are unreachable, the band moves by at most two columns per row
+			const auto& above = bands[static_cast<size_t>(r-1)];
+			for(int c = std::max(band.first - 1, 0); c <= std::min(band.second + 1, cols-1); ++c)
+				if(c < above.first || c > above.second)
+					previous_costs[static_cast<size_t>(c)] = unreachable;
+
+			if(forward)
+				kernel::forward_row(previous_costs.data(), image.ptr<uchar>(r-1), row, current_costs.data(), route_row.data(), band.first, band.second + 1, cols);
+			else
+				kernel::relax_row(previous_costs.data(), row, current_costs.data(), route_row.data(), band.first, band.second + 1, cols);
+		}
+
+		std::copy(route_row.begin() + band.first, route_row.begin() + band.second + 1, routes.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(r) * stride));
+		cell_count += band.second - band.first + 1;
+	}
+
+	// The last minimum of the band, like BasicSeamFinder
+	const auto& last = bands.back();
+	const auto first = current_costs.begin() + last.first;
+	auto col = static_cast<int>(std::max_element(first, current_costs.begin() + last.second + 1, [] (int a, int b) { return !(a < b); }) - current_costs.begin());
+	last_cost = current_costs[static_cast<size_t>(col)];
+
+	path.resize(static_cast<size_t>(image.rows));
+	for(int r = image.rows-1; r >= 0; --r)
+	{
+		path[static_cast<size_t>(r)] = col;
+		col += static_cast<int>(routes[static_cast<size_t>(r) * stride + static_cast<size_t>(col - bands[static_cast<size_t>(r)].first)]);
+	}
+}
@@ -0,0 +1,114 @@
+#ifndef SEAM_PYRAMID_H
+#define SEAM_PYRAMID_H
+
+#include "seam_finder.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief The PyramidSeamFinder class Finds vertical seams coarse to fine for very large images.
+	 * The energy map, or the grayscale image in forward mode, is halved levels times: a 2x2 block of the energy keeps its
+	 * maximum so that thin edges survive, a block of the grayscale image its mean. The coarsest level is searched completely
+	 * like BasicSeamFinder<MinSeam> does, every finer level only within band pixels to both sides of the doubled seam of the
+	 * level below. A seam of the full resolution then costs rows * (2 * band + 2) cells plus one pass over the image to build
+	 * the pyramid, instead of rows * cols cells.
+	 * The seams are approximations: a cheaper seam outside of the band is not found. With 0 levels the search is exact.
+	 */
+	class PyramidSeamFinder
+	{
+	public:
+		/**
+		 * @brief PyramidSeamFinder Creates a finder without state.
+		 * @param levels The number of halved levels below the full resolution, 0 or more. Levels that would be narrower
+		 * than 4 columns are left out.
+		 * @param band The pixels searched to both sides of the refined seam on every finer level, at least 1.
+		 * @param mode What the cumulative energy measures, decides whether seam() takes energy maps or grayscale images.
+		 */
+		explicit PyramidSeamFinder(int levels = 0, int band = 4, EnergyMode mode = EnergyMode::backward);
+
+		/**
+		 * @brief PyramidSeamFinder Copies the settings only, the buffers are rebuilt by every seam() anyway.
+		 * @param other The finder that is copied.
+		 */
+		PyramidSeamFinder(const PyramidSeamFinder& other);
+		PyramidSeamFinder(PyramidSeamFinder&& other) = default;
+		PyramidSeamFinder& operator=(const PyramidSeamFinder& other);
+		PyramidSeamFinder& operator=(PyramidSeamFinder&& other) = default;
+
+		/**
+		 * @brief reserve Allocates the levels and buffers for images of up to size.area() pixels in any orientation.
+		 * Searches on images that fit do not allocate memory afterwards.
+		 * @param size The largest image size that will be searched.
+		 */
+		void reserve(cv::Size size);
+
+		/**
+		 * @brief levels The number of halved levels below the full resolution.
+		 */
+		int levels() const;
+
+		/**
+		 * @brief band The pixels searched to both sides of the refined seam.
+		 */
+		int band() const;
+
+		/**
+		 * @brief mode What the cumulative energy measures.
+		 */
+		EnergyMode mode() const;
+
+		/**
+		 * @brief seam Builds the pyramid of the image and returns the refined vertical seam.
+		 * @param image The 8UC1 energy map, or the grayscale image in forward mode.
+		 * @return The column coordinate for each row. The reference stays valid until the next call.
+		 */
+		const std::vector<int>& seam(const cv::Mat& image);
+
+		/**
+		 * @brief cost The cumulative energy of the last seam in the full resolution.
+		 */
+		int cost() const;
+
+		/**
+		 * @brief cells The number of cells the last seam() computed, summed over all levels.
+		 */
+		long long cells() const;
+
+	private:
+		using Interval = std::pair<int, int>;	// [first, second]
+
+		void refine(const cv::Mat& image, const std::vector<int>& coarse);
+
+		int level_count;
+		int band_width;
+		EnergyMode energy_mode;
+
+		BasicSeamFinder<MinSeam> coarsest;
+
+		// Storage for the halved levels, reused as long as the image fits
+		std::vector<std::vector<uchar>> buffers{};
+		std::vector<cv::Mat> pyramid{};
+
+		// The seam of the level below and the refined one
+		std::vector<int> coarse{};
+		std::vector<int> path{};
+
+		// Cumulative energy of the previous and the current row, only valid within the band of the row
+		std::vector<int> previous_costs{};
+		std::vector<int> current_costs{};
+		std::vector<signed char> route_row{};
+
+		std::vector<Interval> bands{};			// The searched columns of every row
+		std::vector<signed char> routes{};		// Column offsets of the band cells, 2 * band + 2 per row
+
+		int last_cost{0};
+		long long cell_count{0};
+	};
+}
+
+#endif // SEAM_PYRAMID_H
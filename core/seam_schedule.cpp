@@ -0,0 +1,185 @@
+#include "seam_schedule.h"
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace
+{
+	/**
+	 * @brief The Cell struct One image state of the transport map.
+	 */
+	struct Cell
+	{
+		cvutil::SeamCarver carver;
+		long long total{0};	// Energy of all seams removed to get here
+	};
+
+	void check_counts(const cv::Mat& image, int cols, int rows)
+	{
+		if(cols < 0 || rows < 0 || cols >= image.cols || rows >= image.rows)
+		{
+			std::cout << "ERROR: More seams than the image has pixels across them. Seam scheduling not supported!" << std::endl;
+			throw std::invalid_argument{"Seam scheduling applied with invalid seam counts"};
+		}
+	}
+}
+
+cvutil::SeamSchedule cvutil::fixed_schedule(const cv::Mat& image, int cols, int rows, EnergyMode mode, EnergyKernel kernel,
+											const std::function<bool(int, int)>& proceed)
+{
+	check_counts(image, cols, rows);
+
+	auto schedule = SeamSchedule{};
+	schedule.order.assign(static_cast<size_t>(cols), Orientation::vertical);
+	schedule.order.resize(static_cast<size_t>(cols + rows), Orientation::horizontal);
+
+	auto carver = SeamCarver{image, mode, kernel};
+	const auto total = cols + rows;
+	for(int i = 0; i < total; ++i)
+	{
+		const auto orientation = schedule.order[static_cast<size_t>(i)];
+		carver.step(orientation);
+		schedule.cost += carver.cost(orientation);
+
+		if(proceed && !proceed(i + 1, total))
+			return SeamSchedule{};
+	}
+	return schedule;
+}
+
+cvutil::SeamSchedule cvutil::optimal_schedule(const cv::Mat& image, int cols, int rows, EnergyMode mode, EnergyKernel kernel,
+											  const std::function<bool(int, int)>& proceed)
+{
+	check_counts(image, cols, rows);
+	const auto memory = physical_memory();
+	if(memory > 0 && optimal_schedule_memory(image.size(), cols, rows, mode, kernel) > memory)
+	{
+		std::cout << "ERROR: Transport map needs more memory than installed. Seam scheduling not supported!" << std::endl;
+		throw std::invalid_argument{"Seam scheduling applied with too many seams for the memory"};
+	}
+
+	// 0 where the cell was reached by a vertical seam, 1 by a horizontal one
+	auto choices = cv::Mat(rows + 1, cols + 1, CV_8UC1, cv::Scalar(0));
+
+	// Cells of the previous and the current anti-diagonal, indexed by the number of removed rows
+	auto previous = std::vector<std::unique_ptr<Cell>>(static_cast<size_t>(rows + 1));
+	auto current = std::vector<std::unique_ptr<Cell>>(static_cast<size_t>(rows + 1));
+
+	const auto unreachable = std::numeric_limits<long long>::max();
+	auto compute = [&] (int r, int c) {
+		auto& cell = current[static_cast<size_t>(r)];
+		if(r == 0 && c == 0)
+		{
+			cell = std::make_unique<Cell>(Cell{SeamCarver{image, mode, kernel}, 0});
+		}
+		else
+		{
+			// The predecessors are only read, clone() copies the seams they found
+			const auto left = c > 0 ? previous[static_cast<size_t>(r)].get() : nullptr;
+			const auto above = r > 0 ? previous[static_cast<size_t>(r-1)].get() : nullptr;
+			const auto via_left = left ? left->total + left->carver.cost(Orientation::vertical) : unreachable;
+			const auto via_above = above ? above->total + above->carver.cost(Orientation::horizontal) : unreachable;
+
+			const auto vertical = via_left <= via_above;
+			const auto orientation = vertical ? Orientation::vertical : Orientation::horizontal;
+			cell = std::make_unique<Cell>(Cell{(vertical ? left : above)->carver.clone(), vertical ? via_left : via_above});
+			choices.at<uchar>(r, c) = vertical ? 0 : 1;
+
+			// Removes the seam the predecessor found
+			cell->carver.step(orientation);
+		}
+
+		// The seams that lead to the successors, afterwards only the carved images and these seams are kept
+		for(const auto orientation : {Orientation::vertical, Orientation::horizontal})
+			if(orientation == Orientation::vertical ? c < cols : r < rows)
+				cell->carver.find(orientation);
+		cell->carver.compact();
+	};
+
+	auto& pool = thread_pool();
+	const auto cells = (rows + 1) * (cols + 1);
+	auto finished = 0;
+	for(int d = 0; d <= rows + cols; ++d)
+	{
+		// The cells of one anti-diagonal only depend on the previous one
+		const auto first = std::max(0, d - cols);
+		const auto last = std::min(d, rows);
+		if(2 * (last - first + 1) <= pool.size())
+		{
+			// Short diagonals leave the threads to the seam searches
+			for(int r = first; r <= last; ++r)
+				compute(r, d - r);
+		}
+		else
+		{
+			pool.parallel_for(first, last + 1, [&compute, d] (int start, int end) {
+				for(int r = start; r < end; ++r)
+					compute(r, d - r);
+			});
+		}
+
+		std::swap(previous, current);
+		for(auto& cell : current)
+			cell.reset();
+
+		finished += last - first + 1;
+		if(proceed && !proceed(finished, cells))
+			return SeamSchedule{};
+	}
+
+	// Walk back from the fully carved cell
+	auto schedule = SeamSchedule{};
+	schedule.cost = previous[static_cast<size_t>(rows)]->total;
+	schedule.order.resize(static_cast<size_t>(rows + cols));
+	for(int r = rows, c = cols; r + c > 0;)
+	{
+		const auto vertical = choices.at<uchar>(r, c) == 0;
+		schedule.order[static_cast<size_t>(r + c - 1)] = vertical ? Orientation::vertical : Orientation::horizontal;
+		if(vertical)
+			--c;
+		else
+			--r;
+	}
+	return schedule;
+}
+
+size_t cvutil::optimal_schedule_memory(cv::Size size, int cols, int rows, EnergyMode mode, EnergyKernel kernel)
+{
+	const auto area = static_cast<size_t>(size.area());
+	const auto length = static_cast<size_t>(std::max(size.width, size.height));
+	const auto backward = mode == EnergyMode::backward;
+	const auto color = backward && energy_functions(kernel).source_type == CV_8UC3;
+
+	// Bytes per pixel of the grayscale image, the energy map and the color image
+	const auto channels = size_t{1} + (backward ? 1 : 0) + (color ? 3 : 0);
+
+	// A compacted cell keeps its images, the last removed seam and the seams of both orientations
+	const auto diagonal = static_cast<size_t>(std::min(cols, rows) + 1);
+	const auto cells = 2 * diagonal * (channels * area + 3 * length * sizeof(int));
+
+	// A cell being carved has both orientations of the images and index maps, and two finders of one cost and 2 route bits per pixel
+	const auto threads = std::min(static_cast<size_t>(thread_pool().size()), diagonal);
+	const auto carving = threads * (2 * (channels + sizeof(cv::Vec<int, 2>)) * area + 2 * (sizeof(int) * area + area / 4));
+
+	const auto choices = static_cast<size_t>(rows + 1) * static_cast<size_t>(cols + 1);
+	return cells + carving + choices;
+}
+
+size_t cvutil::physical_memory()
+{
+#if (defined(__unix__) || defined(__APPLE__)) && defined(_SC_PHYS_PAGES)
+	const auto pages = sysconf(_SC_PHYS_PAGES);
+	const auto page = sysconf(_SC_PAGESIZE);
+	if(pages > 0 && page > 0)
+		return static_cast<size_t>(pages) * static_cast<size_t>(page);
+#endif
+	return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef SEAM_SCHEDULE_H
+#define SEAM_SCHEDULE_H
+
+#include "seam_carver.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief The SeamSchedule struct The order in which vertical and horizontal seams are removed, and what it costs.
+	 */
+	struct SeamSchedule
+	{
+		std::vector<Orientation> order{};	// The orientation of every removed seam, in removal order
+		long long cost{0};					// Sum of the cumulative energies of the removed seams
+	};
+
+	/**
+	 * @brief fixed_schedule Removes all vertical seams first and all horizontal seams afterwards, like the GUI always did.
+	 * The seams are carved once to sum up their energies.
+	 * @param image The 8UC3 or 8UC1 image. It is not modified.
+	 * @param cols The number of vertical seams, smaller than image.cols.
+	 * @param rows The number of horizontal seams, smaller than image.rows.
+	 * @param mode What the cumulative energy of the seams measures.
+	 * @param kernel The energy function of backward energy, forward energy ignores it.
+	 * @param proceed Called after every seam with the number of removed and of all seams. Returning false stops the
+	 * computation and returns an empty schedule. May be empty.
+	 * @return The schedule and its cost.
+	 */
+	SeamSchedule fixed_schedule(const cv::Mat& image, int cols, int rows, EnergyMode mode = EnergyMode::backward,
+								EnergyKernel kernel = EnergyKernel::sobel, const std::function<bool(int, int)>& proceed = {});
+
+	/**
+	 * @brief optimal_schedule Interleaves the seam removals by the transport map of Avidan and Shamir, a greedy approximation.
+	 * Cell (r, c) of the map is the image after removing r horizontal and c vertical seams, reached from (r, c-1) by a vertical or
+	 * from (r-1, c) by a horizontal seam, whichever gives the smaller total. Every cell keeps only the one image it was reached
+	 * with, so a choice that is cheaper at a cell can make the following seams more expensive: the order is not guaranteed to be
+	 * optimal and can even cost more than fixed_schedule. Callers compare both and carve the cheaper one. Only two anti-diagonals of carver states are kept at a
+	 * time, and the cells of one anti-diagonal are computed in parallel since they only depend on the one before.
+	 * Every cell clones the state of its predecessor, removes the seam the predecessor already found and searches both seams of
+	 * the carved image, then compacts the state (see SeamCarver::compact) to the carved images and the two seams.
+	 * Memory grows with the length of the anti-diagonals, see optimal_schedule_memory.
+	 * @param image The 8UC3 or 8UC1 image. It is not modified.
+	 * @param cols The number of vertical seams, smaller than image.cols.
+	 * @param rows The number of horizontal seams, smaller than image.rows.
+	 * @param mode What the cumulative energy of the seams measures.
+	 * @param kernel The energy function of backward energy, forward energy ignores it.
+	 * @param proceed Called after every anti-diagonal with the number of finished and of all cells. Returning false stops the
+	 * computation and returns an empty schedule. May be empty.
+	 * @return The schedule of the transport map and its cost. Ties prefer the vertical seam.
+	 * @throws std::invalid_argument if the seam counts are invalid or optimal_schedule_memory exceeds physical_memory.
+	 */
+	SeamSchedule optimal_schedule(const cv::Mat& image, int cols, int rows, EnergyMode mode = EnergyMode::backward,
+								  EnergyKernel kernel = EnergyKernel::sobel, const std::function<bool(int, int)>& proceed = {});
+
+	/**
+	 * @brief optimal_schedule_memory Estimates the peak memory of optimal_schedule in bytes, an upper bound.
+	 * Two anti-diagonals of up to min(cols, rows) + 1 compacted cells hold the carved grayscale image, the energy map in backward
+	 * mode, the color image for kernels that read colors and two seams. Every thread of the pool additionally carves one full
+	 * carver state with index maps and seam finders in both orientations.
+	 * @param size The size of the image.
+	 * @param cols The number of vertical seams.
+	 * @param rows The number of horizontal seams.
+	 * @param mode What the cumulative energy of the seams measures.
+	 * @param kernel The energy function of backward energy, forward energy ignores it.
+	 * @return The estimated bytes.
+	 */
+	size_t optimal_schedule_memory(cv::Size size, int cols, int rows, EnergyMode mode = EnergyMode::backward,
+								   EnergyKernel kernel = EnergyKernel::sobel);
+
+	/**
+	 * @brief physical_memory The installed memory in bytes.
+	 * @return The bytes, or 0 if the platform does not tell.
+	 */
+	size_t physical_memory();
+}
+
+#endif // SEAM_SCHEDULE_H
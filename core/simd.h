@@ -0,0 +1,50 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Instruction sets the kernels may use.
+// SSE2 is decided at compile time, SSSE3 and AVX2 functions are compiled with a target attribute and selected at runtime.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CVUTIL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CVUTIL_AVX2 1
+#define CVUTIL_TARGET_AVX2 __attribute__((target("avx2")))
+#define CVUTIL_SSSE3 1
+#define CVUTIL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#include <immintrin.h>
+#endif
+
+namespace cvutil::simd
+{
+	/**
+	 * @brief has_avx2 Checks once whether the CPU supports AVX2.
+	 * @return True if functions marked CVUTIL_TARGET_AVX2 may be called.
+	 */
+	inline bool has_avx2()
+	{
+#ifdef CVUTIL_AVX2
+		static const bool supported = __builtin_cpu_supports("avx2");
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief has_ssse3 Checks once whether the CPU supports SSSE3.
+	 * @return True if functions marked CVUTIL_TARGET_SSSE3 may be called.
+	 */
+	inline bool has_ssse3()
+	{
+#ifdef CVUTIL_SSSE3
+		static const bool supported = __builtin_cpu_supports("ssse3");
+		return supported;
+#else
+		return false;
+#endif
+	}
+}
+
+#endif // SIMD_H
@@ -0,0 +1,237 @@
+#include "stream_carver.h"
+
+#include "energy_kernel.h"
+#include "mapped_file.h"
+#include "route_matrix.h"
+#include "seam_kernel.h"
+#include "thread_pool.h"
+#include "tiled_rows.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	/**
+	 * @brief The PpmHeader struct Size and pixel offset of a P6 file.
+	 */
+	struct PpmHeader
+	{
+		int width{0};
+		int height{0};
+		size_t offset{0};	// First byte of the pixels
+	};
+
+	[[noreturn]] void invalid_ppm(const std::string& path)
+	{
+		std::cout << "ERROR: " << path << " is no binary PPM (P6) with 8 bit values. Stream carving not supported!" << std::endl;
+		throw std::invalid_argument{"Stream carving applied to a file that is no P6 image: " + path};
+	}
+
+	/**
+	 * @brief read_header Parses the header of a P6 file, including comment lines.
+	 */
+	PpmHeader read_header(const std::string& path)
+	{
+		auto file = std::ifstream{path, std::ios::binary};
+		if(!file)
+		{
+			std::cout << "ERROR: Cannot open " << path << " for reading." << std::endl;
+			throw std::runtime_error{"Stream carving input could not be opened: " + path};
+		}
+
+		auto magic = std::string(2, '\0');
+		file.read(&magic[0], 2);
+		if(magic != "P6")
+			invalid_ppm(path);
+
+		// Width, height and maximum value, each after whitespace and comments
+		int values[3] = {0, 0, 0};
+		for(auto& value : values)
+		{
+			for(auto next = file.peek(); std::isspace(next) || next == '#'; next = file.peek())
+			{
+				if(next == '#')
+					file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+				else
+					file.get();
+			}
+			if(!(file >> value) || value <= 0)
+				invalid_ppm(path);
+		}
+		if(values[2] != 255 || !std::isspace(file.get()))
+			invalid_ppm(path);
+
+		const auto header = PpmHeader{values[0], values[1], static_cast<size_t>(file.tellg())};
+		if(std::filesystem::file_size(path) < header.offset + static_cast<size_t>(header.width) * header.height * 3)
+			invalid_ppm(path);
+		return header;
+	}
+}
+
+cvutil::StreamReport cvutil::stream_carve(const std::string& input, const std::string& output, int width, size_t memory_limit,
+										  EnergyMode mode)
+{
+	const auto header = read_header(input);
+	const auto cols = header.width;
+	const auto rows = header.height;
+	if(width < 1 || width > cols)
+	{
+		std::cout << "ERROR: Target width " << width << " is outside of 1 to " << cols << ". Stream carving not supported!" << std::endl;
+		throw std::invalid_argument{"Stream carving applied with invalid width"};
+	}
+
+	// Fixed: two cost rows, the seam, a row to copy through, two private cost rows and a row of unpacked routes per thread,
+	// two halo rows and the page alignment of two windows. Per strip row: the pixels, the grayscale row, the packed routes
+	// and the energy row of backward energy.
+	const auto backward = mode == EnergyMode::backward;
+	const auto row_bytes = static_cast<size_t>(cols) * 3;
+	const auto route_bytes = static_cast<size_t>(cols + 3) / 4;
+	const auto threads = thread_pool().clamp_tasks(cols);
+	const auto fixed = 2 * sizeof(int) * cols + sizeof(int) * rows + row_bytes + static_cast<size_t>(threads) * (2 * sizeof(int) + 1) * cols
+					   + 2 * (row_bytes + cols) + 2 * MappedFile::page_size();
+	const auto per_row = row_bytes + static_cast<size_t>(cols) * (backward ? 2 : 1) + route_bytes;
+	if(memory_limit < fixed + per_row)
+	{
+		std::cout << "ERROR: Memory limit below " << fixed + per_row << " bytes. Stream carving not supported!" << std::endl;
+		throw std::invalid_argument{"Stream carving applied with a memory limit that does not fit one row"};
+	}
+	const auto strip = static_cast<int>(std::min<size_t>((memory_limit - fixed) / per_row, static_cast<size_t>(rows)));
+
+	std::filesystem::copy_file(input, output, std::filesystem::copy_options::overwrite_existing);
+	const auto scratch = output + ".routes";
+	auto image = MappedFile{output};
+	auto routes = MappedFile{scratch, route_bytes * rows};
+
+	auto gray = std::vector<uchar>(static_cast<size_t>(strip + 2) * cols);
+	auto energy = std::vector<uchar>(backward ? static_cast<size_t>(strip) * cols : 0);
+	std::vector<int> costs[2] = {std::vector<int>(static_cast<size_t>(cols)), std::vector<int>(static_cast<size_t>(cols))};
+	auto tiles = TileBuffers<int>{};
+	tiles.reserve(threads, cols);
+	auto seam = std::vector<int>(static_cast<size_t>(rows));
+	auto& pool = thread_pool();
+
+	// Every pass removes the seam of the pass before and searches the next one, the last pass only removes
+	const auto seams = cols - width;
+	for(int s = 0; s <= seams; ++s)
+	{
+		const auto w = cols - s;	// The width after the removal
+		auto removed_until = 0;		// Rows above hold the width w already
+		auto top = 0;				// The cost buffer of the last computed row
+		for(int start = 0; start < rows; start += strip)
+		{
+			const auto end = std::min(start + strip, rows);
+			const auto first = std::max(start - 1, 0);
+			const auto last = std::min(end + 1, rows);
+			auto window = image.map(header.offset + first * row_bytes, (last - first) * row_bytes);
+			auto pixels = [&window, first, row_bytes] (int r) { return window.data() + (r - first) * row_bytes; };
+
+			if(s > 0)
+			{
+				for(int r = removed_until; r < last; ++r)
+				{
+					const auto c = seam[static_cast<size_t>(r)];
+					std::memmove(pixels(r) + 3 * c, pixels(r) + 3 * (c + 1), static_cast<size_t>(w - c) * 3);
+				}
+				removed_until = last;
+			}
+			if(s == seams)
+				continue;
+
+			// Grayscale rows of the strip and its halo, energy rows of the strip
+			auto gray_at = [&gray, first, cols] (int r) { return gray.data() + static_cast<size_t>(r - first) * cols; };
+			pool.parallel_for(first, last, [&] (int begin, int finish) {
+				for(int r = begin; r < finish; ++r)
+					kernel::gray_row(pixels(r), gray_at(r), w);
+			});
+			if(backward)
+			{
+				pool.parallel_for(start, end, [&] (int begin, int finish) {
+					for(int r = begin; r < finish; ++r)
+						kernel::sobel_row(gray_at(std::max(r-1, 0)), gray_at(r), gray_at(std::min(r+1, rows-1)), energy.data() + static_cast<size_t>(r - start) * cols, w);
+				});
+			}
+			auto local = [&] (int r) { return backward ? energy.data() + static_cast<size_t>(r - start) * cols : gray_at(r); };
+
+			// The routes are packed to 2 bits per cell, the first row has none
+			auto route_window = routes.map(start * route_bytes, (end - start) * route_bytes);
+			auto route = [&route_window, start, route_bytes] (int r) { return route_window.data() + (r - start) * route_bytes; };
+			if(start == 0)
+			{
+				for(int c = 0; c < w; ++c)
+					costs[0][static_cast<size_t>(c)] = backward ? local(0)[c] : kernel::forward_top(gray_at(0), c, w);
+				top = 0;
+			}
+
+			// One block of columns per thread and a barrier after every band of rows (see tiled_rows), the last rows of the
+			// bands alternate between the cost buffers. top is the one that holds the row above the strip.
+			const auto bands = tiled_rows<int>(std::max(start, 1), end, w, tiles, costs[top].data(),
+				[&costs, top] (int b, int) { return costs[(top + b + 1) % 2].data(); },
+				[&] (const TileRow<int>& tile) {
+					const auto r = tile.row;
+					if(backward)
+						kernel::relax_row(tile.prev, local(r), tile.cur, tile.offsets, tile.begin, tile.finish, w);
+					else
+						kernel::forward_row(tile.prev, gray_at(r-1), gray_at(r), tile.cur, tile.offsets, tile.begin, tile.finish, w);
+					pack_routes(tile.offsets, route(r), tile.start, tile.end);
+				});
+			top = (top + bands) % 2;
+		}
+		if(s == seams)
+			break;
+
+		// The last minimum, like BasicSeamFinder, traced back from the bottom strip up
+		const auto& bottom = costs[top];
+		auto col = static_cast<int>(std::max_element(bottom.begin(), bottom.begin() + w, [] (int a, int b) { return !(a < b); }) - bottom.begin());
+		for(int end = rows; end > 0; end -= strip)
+		{
+			const auto start = std::max(end - strip, 0);
+			const auto route_window = routes.map(start * route_bytes, (end - start) * route_bytes);
+			for(int r = end-1; r >= start; --r)
+			{
+				seam[static_cast<size_t>(r)] = col;
+				if(r > 0)
+					col += route_at(route_window.data() + (r - start) * route_bytes, col);
+			}
+		}
+	}
+
+	// The buffers are dropped, the strips below map a source and a target window
+	gray = std::vector<uchar>{};
+	energy = std::vector<uchar>{};
+
+	// Pack the rows behind the new header. The header only gets shorter and every row moves to a lower offset,
+	// so the target of a row never overlaps the rows that are still to be moved.
+	const auto text = "P6\n" + std::to_string(width) + " " + std::to_string(rows) + "\n255\n";
+	if(text.size() > header.offset)
+		invalid_ppm(input);
+	const auto packed_bytes = static_cast<size_t>(width) * 3;
+	auto copy = std::vector<uchar>(packed_bytes);
+	const auto half = std::max(strip / 2, 1);
+	for(int start = 0; start < rows; start += half)
+	{
+		const auto end = std::min(start + half, rows);
+		const auto source = image.map(header.offset + start * row_bytes, (end - start) * row_bytes);
+		const auto target = image.map(text.size() + start * packed_bytes, (end - start) * packed_bytes);
+		for(int r = start; r < end; ++r)
+		{
+			std::memcpy(copy.data(), source.data() + (r - start) * row_bytes, packed_bytes);
+			std::memcpy(target.data() + (r - start) * packed_bytes, copy.data(), packed_bytes);
+		}
+	}
+	{
+		const auto head = image.map(0, text.size());
+		std::memcpy(head.data(), text.data(), text.size());
+	}
+	image.resize(text.size() + rows * packed_bytes);
+	std::filesystem::remove(scratch);
+
+	return StreamReport{strip, fixed + static_cast<size_t>(strip) * per_row};
+}
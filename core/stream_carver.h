@@ -0,0 +1,41 @@
+#ifndef STREAM_CARVER_H
+#define STREAM_CARVER_H
+
+#include "seam_policy.h"
+
+#include <cstddef>
+#include <string>
+
+namespace cvutil
+{
+	/**
+	 * @brief The StreamReport struct How stream_carve divided the image.
+	 */
+	struct StreamReport
+	{
+		int strip_rows{0};		// Rows per strip
+		size_t memory{0};		// Bytes of buffers and mapped windows at once, at most the limit
+	};
+
+	/**
+	 * @brief stream_carve Removes vertical seams from a binary PPM file whose pixels do not fit into the memory.
+	 * The output file is a copy of the input that is carved in place: every seam costs one pass over the image in strips of
+	 * rows mapped from the file, which removes the previous seam, computes grayscale image, energy and cumulative energy of
+	 * the strip and writes the routes, packed to 2 bits per cell, into a scratch file next to the output. The cumulative
+	 * energy keeps two shared rows and two private rows per thread. The seam is then traced back through the scratch file
+	 * from the bottom strip up, so only the seam itself is held in full. The strips are as high as the memory limit allows.
+	 * The seams are identical to the ones of SeamCarver.
+	 * @param input The P6 file with a maximum value of 255.
+	 * @param output Receives the carved P6 file, overwritten. The scratch file output + ".routes" is removed afterwards.
+	 * @param width The target width, from 1 to the width of the input.
+	 * @param memory_limit Bytes of buffers and mapped windows at once. Needs a few rows of the image at least.
+	 * @param mode What the cumulative energy of the seams measures.
+	 * @return The strip height and the memory it takes.
+	 * @throws std::invalid_argument if the input is no P6 file, the width is out of range or the limit is too small.
+	 * @throws std::runtime_error if a file cannot be opened, mapped or resized.
+	 */
+	StreamReport stream_carve(const std::string& input, const std::string& output, int width, size_t memory_limit,
+							  EnergyMode mode = EnergyMode::backward);
+}
+
+#endif // STREAM_CARVER_H
@@ -0,0 +1,174 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+	// Set while a thread executes a task of any pool, used to run nested calls inline
+	thread_local bool inside_task = false;
+
+	std::mutex global_mutex;
+	std::unique_ptr<cvutil::ThreadPool> global_pool;
+}
+
+cvutil::Barrier::Barrier(int count)
+	: count{std::max(count, 1)}
+{
+}
+
+void cvutil::Barrier::wait()
+{
+	const auto current = phase.load(std::memory_order_acquire);
+	if(arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == count)
+	{
+		// Last thread of this phase releases all others
+		arrived.store(0, std::memory_order_relaxed);
+		phase.fetch_add(1, std::memory_order_release);
+		return;
+	}
+
+	for(int spin = 0; phase.load(std::memory_order_acquire) == current; ++spin)
+		if(spin >= 1024)
+			std::this_thread::yield();
+}
+
+cvutil::ThreadPool::ThreadPool(int thread_count)
+{
+	if(thread_count < 1)
+		thread_count = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	// The calling thread always works as task 0
+	workers.reserve(static_cast<size_t>(thread_count-1));
+	for(int t = 1; t < thread_count; ++t)
+		workers.emplace_back([this, t] () { work(t); });
+}
+
+cvutil::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stopping = true;
+	}
+	wake.notify_all();
+	for(auto& t : workers)
+		t.join();
+}
+
+int cvutil::ThreadPool::size() const
+{
+	return static_cast<int>(workers.size()) + 1;
+}
+
+int cvutil::ThreadPool::clamp_tasks(int task_count) const
+{
+	return inside_task ? 1 : std::clamp(task_count, 1, size());
+}
+
+void cvutil::ThreadPool::dispatch(int task_count, Invoker invoke, void* context)
+{
+	task_count = clamp_tasks(task_count);
+
+	// Nested calls and single tasks do not need the workers
+	if(task_count == 1)
+	{
+		const auto outer = inside_task;
+		inside_task = true;
+		try
+		{
+			invoke(context, 0, 1);
+		}
+		catch(...)
+		{
+			inside_task = outer;
+			throw;
+		}
+		inside_task = outer;
+		return;
+	}
+
+	std::lock_guard<std::mutex> dispatch_lock{dispatch_mutex};
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		this->invoke = invoke;
+		this->context = context;
+		active = task_count;
+		pending = task_count-1;
+		error = nullptr;
+		++generation;
+	}
+	wake.notify_all();
+
+	// Work on task 0 in the calling thread
+	auto own_error = std::exception_ptr{};
+	inside_task = true;
+	try
+	{
+		invoke(context, 0, task_count);
+	}
+	catch(...)
+	{
+		own_error = std::current_exception();
+	}
+	inside_task = false;
+
+	std::unique_lock<std::mutex> lock{mutex};
+	done.wait(lock, [this] () { return pending == 0; });
+
+	if(own_error)
+		std::rethrow_exception(own_error);
+	if(error)
+		std::rethrow_exception(error);
+}
+
+void cvutil::ThreadPool::work(int index)
+{
+	auto seen = 0ul;
+	for(;;)
+	{
+		std::unique_lock<std::mutex> lock{mutex};
+		wake.wait(lock, [this, &seen] () { return stopping || generation != seen; });
+		if(stopping)
+			return;
+		seen = generation;
+
+		// Threads beyond the requested task count sit this generation out
+		if(index >= active)
+			continue;
+
+		const auto count = active;
+		lock.unlock();
+
+		inside_task = true;
+		try
+		{
+			invoke(context, index, count);
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> error_lock{mutex};
+			if(!error)
+				error = std::current_exception();
+		}
+		inside_task = false;
+
+		lock.lock();
+		if(--pending == 0)
+			done.notify_one();
+	}
+}
+
+cvutil::ThreadPool& cvutil::thread_pool()
+{
+	std::lock_guard<std::mutex> lock{global_mutex};
+	if(!global_pool)
+		global_pool = std::make_unique<ThreadPool>();
+	return *global_pool;
+}
+
+void cvutil::set_thread_count(int thread_count)
+{
+	std::lock_guard<std::mutex> lock{global_mutex};
+	global_pool.reset();
+	global_pool = std::make_unique<ThreadPool>(thread_count);
+}
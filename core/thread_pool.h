@@ -0,0 +1,137 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief The Barrier class Blocks a fixed number of threads until all of them have arrived.
+	 * The barrier resets itself, so it can be used once per phase (e.g. once per row of a dynamic program).
+	 * Waiting threads spin briefly before yielding, because phases are usually very short.
+	 */
+	class Barrier
+	{
+	public:
+		/**
+		 * @brief Barrier Creates a barrier for count threads.
+		 * @param count The number of threads that have to call wait() per phase.
+		 */
+		explicit Barrier(int count);
+
+		/**
+		 * @brief wait Blocks until all threads of the current phase have called wait().
+		 */
+		void wait();
+
+	private:
+		const int count;
+		std::atomic<int> arrived{0};
+		std::atomic<unsigned> phase{0};
+	};
+
+	/**
+	 * @brief The ThreadPool class Long-lived worker threads that execute phased work without being recreated per call.
+	 * The calling thread always takes part in the work as task 0, so a pool of size n owns n-1 threads.
+	 */
+	class ThreadPool
+	{
+	public:
+		/**
+		 * @brief ThreadPool Starts the worker threads.
+		 * @param thread_count The number of threads that work on a task, including the calling thread.
+		 * Values < 1 select std::thread::hardware_concurrency().
+		 */
+		explicit ThreadPool(int thread_count = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * @brief size The number of threads that work on a task, including the calling thread.
+		 */
+		int size() const;
+
+		/**
+		 * @brief clamp_tasks The number of tasks run() will actually execute for a request of task_count tasks.
+		 * Use it to size synchronization objects like Barrier before calling run().
+		 * @param task_count The requested number of tasks.
+		 * @return task_count clamped to [1, size()], or 1 when called from inside a running task.
+		 */
+		int clamp_tasks(int task_count) const;
+
+		template<typename F>
+		/**
+		 * @brief run Calls task(index, task_count) once for every index in [0, task_count) concurrently and blocks until all calls returned.
+		 * The tasks may synchronize with each other (e.g. through a Barrier of task_count), since every index runs on its own thread.
+		 * Calls from inside a running task are executed inline with task_count = 1.
+		 * @param task_count The requested number of tasks, clamped to [1, size()].
+		 * @param task The callable that is executed. Exceptions are rethrown in the calling thread.
+		 */
+		void run(int task_count, F&& task)
+		{
+			dispatch(task_count, [] (void* context, int index, int count) { (*static_cast<std::remove_reference_t<F>*>(context))(index, count); },
+					 const_cast<void*>(static_cast<const void*>(&task)));
+		}
+
+		template<typename F>
+		/**
+		 * @brief parallel_for Splits [begin, end) into one contiguous block per thread and calls body(start, stop) for each block.
+		 * @param begin The first index.
+		 * @param end The index after the last one.
+		 * @param body The callable that processes one block.
+		 */
+		void parallel_for(int begin, int end, F&& body)
+		{
+			if(end <= begin)
+				return;
+			run(end - begin, [begin, end, &body] (int index, int count) {
+				// Calculate the start and end of the working interval for this thread
+				body(begin + (end - begin) * index / count, begin + (end - begin) * (index+1) / count);
+			});
+		}
+
+	private:
+		using Invoker = void (*)(void*, int, int);
+
+		void dispatch(int task_count, Invoker invoke, void* context);
+		void work(int index);
+
+		std::vector<std::thread> workers{};
+
+		std::mutex dispatch_mutex{};	// Serializes run() calls from different threads
+		std::mutex mutex{};
+		std::condition_variable wake{};
+		std::condition_variable done{};
+
+		unsigned long generation{0};
+		int active{0};
+		int pending{0};
+		Invoker invoke{nullptr};
+		void* context{nullptr};
+		std::exception_ptr error{};
+		bool stopping{false};
+	};
+
+	/**
+	 * @brief thread_pool The pool shared by all image operations of cvutil.
+	 * @return The global pool, created with the hardware concurrency on first use.
+	 */
+	ThreadPool& thread_pool();
+
+	/**
+	 * @brief set_thread_count Replaces the global pool by one with the given number of threads.
+	 * Must not be called while another thread uses the pool.
+	 * @param thread_count The new thread count. Values < 1 select std::thread::hardware_concurrency().
+	 */
+	void set_thread_count(int thread_count);
+}
+
+#endif // THREAD_POOL_H
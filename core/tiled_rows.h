@@ -0,0 +1,121 @@
+#ifndef TILED_ROWS_H
+#define TILED_ROWS_H
+
+#include "route_matrix.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace cvutil
+{
+	/**
+	 * @brief band_rows The rows per band of tiled_rows, for blocks of the given width.
+	 * Every band recomputes about rows^2 cells of the neighbouring blocks per thread, against width * rows own cells.
+	 * An eighth of the width keeps that overhead at 12.5% while the barriers get rarer by the same factor.
+	 * @param width The columns per thread.
+	 */
+	inline int band_rows(int width)
+	{
+		return std::min(std::max(width / 8, 1), 64);
+	}
+
+	template<typename Cost>
+	/**
+	 * @brief The TileRow struct One row of one thread in tiled_rows.
+	 */
+	struct TileRow
+	{
+		int row;
+		const Cost* prev;		// The costs of the row above, valid in [begin-1, finish+1) within the row
+		Cost* cur;				// Receives the costs of [begin, finish)
+		signed char* offsets;	// Receives the route offsets of [begin, finish), private to the thread
+		int start;				// The own block [start, end), aligned to the packed route bytes
+		int end;
+		int begin;				// The computed cells [begin, finish), the own block plus the halo
+		int finish;
+	};
+
+	template<typename Cost>
+	/**
+	 * @brief The TileBuffers struct The private rows of the threads of tiled_rows, kept between searches to avoid allocations.
+	 */
+	struct TileBuffers
+	{
+		std::vector<Cost> rows{};				// Two cost rows per thread
+		std::vector<signed char> offsets{};		// One row of route offsets per thread
+
+		/**
+		 * @brief reserve Allocates the rows for up to threads threads and rows of up to cols columns.
+		 */
+		void reserve(int threads, int cols)
+		{
+			const auto size = static_cast<size_t>(threads) * static_cast<size_t>(cols);
+			if(rows.size() < 2 * size)
+				rows.resize(2 * size);
+			if(offsets.size() < size)
+				offsets.resize(size);
+		}
+	};
+
+	template<typename Cost, typename Edge, typename Row>
+	/**
+	 * @brief tiled_rows Runs a seam search dynamic program over the rows [first, last) with one block of columns per thread
+	 * and one barrier per band of rows (see band_rows) instead of one per row.
+	 * A cell depends on three cells of the row before, so row k of a band of n rows depends on n-1-k more columns on both
+	 * sides of the block. Every thread computes this trapezoid in private rows instead of waiting for its neighbours, the
+	 * overlapping cells are computed the same way as by their owner. Only the last row of a band is shared: every thread
+	 * writes its block of it into edge(band, row), which all threads read during the next band.
+	 * A single thread makes every row a band of its own, so all rows go straight to their edge rows.
+	 * @param first The first row to compute, row first-1 is top.
+	 * @param last The row after the last one.
+	 * @param cols The number of columns.
+	 * @param buffers The private rows, grown if they do not fit the threads and columns.
+	 * @param top The complete costs of row first-1.
+	 * @param edge Called as edge(band, row) with the band index from 0 and its last row. Returns the cols costs that
+	 * receive that row, which must differ from the one of the band before.
+	 * @param row Called with every TileRow. Computes the cells [begin, finish) of cur and offsets from prev, and packs the
+	 * routes of the own block [start, end), which no other thread writes.
+	 * @return The number of bands, the last row lies in the edge of band count-1, or in top if there are none.
+	 */
+	int tiled_rows(int first, int last, int cols, TileBuffers<Cost>& buffers, const Cost* top, Edge&& edge, Row&& row)
+	{
+		if(last <= first)
+			return 0;
+
+		auto& pool = thread_pool();
+		const auto thread_count = pool.clamp_tasks(cols);
+		const auto tile = thread_count == 1 ? 1 : band_rows(cols / thread_count);
+		buffers.reserve(thread_count, cols);
+		auto barrier = Barrier{thread_count};
+
+		pool.run(cols, [&buffers, &edge, &row, &barrier, first, last, cols, top, tile] (int t, int count) {
+			// Calculate the start and end of the working interval for this thread, aligned to the packed bytes of the routes
+			const int start = RouteMatrix::block_begin(cols, t, count, RouteMatrix::byte_cells);
+			const int end = RouteMatrix::block_begin(cols, t+1, count, RouteMatrix::byte_cells);
+			const auto rows = buffers.rows.data() + 2 * static_cast<size_t>(t) * cols;
+			const auto offsets = buffers.offsets.data() + static_cast<size_t>(t) * cols;
+
+			for(int band = first, b = 0; band < last; band += tile, ++b)
+			{
+				const auto band_end = std::min(band + tile, last);
+				const Cost* prev = b == 0 ? top : edge(b-1, band-1);
+				for(int r = band; r < band_end && start < end; ++r)
+				{
+					// The trapezoid shrinks by one column per side and row, the last row of the band is the block itself
+					const auto halo = band_end - 1 - r;
+					const auto cur = halo == 0 ? edge(b, r) : rows + static_cast<size_t>((r - band) % 2) * cols;
+					row(TileRow<Cost>{r, prev, cur, offsets, start, end, std::max(start - halo, 0), std::min(end + halo, cols)});
+					prev = cur;
+				}
+
+				// The next band reads the neighbouring blocks of this one
+				barrier.wait();
+			}
+		});
+		return (last - first + tile - 1) / tile;
+	}
+}
+
+#endif // TILED_ROWS_H
@@ -0,0 +1,468 @@
+#include "MainWindow.hpp"
+
+#include "cv_utility.h"
+#include "seam_carver.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+MainWindow::MainWindow(QWidget *parent) :
+    QMainWindow(parent)
+{
+    /* Initialisiere die UI Komponenten */
+    setupUi();
+
+    /* Berechnungen laufen in einem eigenen Thread, damit die Oberflaeche bedienbar bleibt */
+    qRegisterMetaType<SeamJob>();
+    qRegisterMetaType<SeamResult>();
+    qRegisterMetaType<cv::Mat>();
+
+    worker = new SeamWorker();
+    worker->moveToThread(&workerThread);
+    connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this,   &MainWindow::startJob,    worker, &SeamWorker::run);
+    connect(worker, &SeamWorker::progress,  this, &MainWindow::onWorkerProgress);
+    connect(worker, &SeamWorker::preview,   this, &MainWindow::onWorkerPreview);
+    connect(worker, &SeamWorker::finished,  this, &MainWindow::onWorkerFinished);
+    connect(worker, &SeamWorker::cancelled, this, &MainWindow::onWorkerCancelled);
+    connect(worker, &SeamWorker::failed,    this, &MainWindow::onWorkerFailed);
+    workerThread.start();
+}
+
+MainWindow::~MainWindow()
+{
+    /* breche laufende Berechnungen ab und warte auf den Worker */
+    worker->cancel(jobId);
+    workerThread.quit();
+    workerThread.wait();
+
+    /* loesche die UI Komponenten */
+    delete centralWidget;    
+    
+    /* schliesse alle offenen Fenster */
+    cv::destroyAllWindows();
+}
+
+/* Methode oeffnet ein Bild und zeigt es in der Vorschau an */
+void MainWindow::on_pbOpenImage_clicked()
+{
+    /* oeffne Bild mit Hilfe eines Dateidialogs */
+	QString imagePath = QFileDialog::getOpenFileName(this, "Open Image...", QString(), QString("Images *.png *.jpg *.tiff *.tif *.jpeg"));
+    
+    /* wenn ein gueltiger Dateipfad angegeben worden ist... */
+    if(!imagePath.isNull() && !imagePath.isEmpty())
+    {
+        /* ...lese das Bild ein */
+        cv::Mat img = cv::imread(QtOpencvCore::qstr2str(imagePath));
+        
+        /* wenn das Bild erfolgreich eingelesen worden ist... */
+        if(!img.empty())
+        {
+            /* ...verwerfe laufende Berechnungen fuer das alte Bild... */
+            worker->cancel(jobId);
+            ++jobId;
+            jobEnded(QString());
+
+            /* ...merke das Originalbild... */
+            originalImage = img;
+			columnOrder = cvutil::SeamOrder{};
+			rowOrder = cvutil::SeamOrder{};
+			enlarged = cv::Mat{};
+			vertical_seams.clear();
+			horizontal_seams.clear();
+			origin = cv::Mat{};
+			interleaved = false;
+            
+            /* ...aktiviere das UI... */
+            enableGUI();
+            
+            /* ...zeige das Originalbild in der Vorschau an */
+			cv::cvtColor(originalImage, rgbImage, cv::COLOR_BGR2RGB);
+			preview->reserve(originalImage.size());
+			preview->present(originalImage);
+			slWidth->setEnabled(false);
+			slHeight->setEnabled(false);
+
+			// Negative values insert seams
+			sbRows->setMinimum(-(originalImage.rows-2));
+			sbRows->setMaximum(originalImage.rows-2);
+			sbCols->setMinimum(-(originalImage.cols-2));
+			sbCols->setMaximum(originalImage.cols-2);
+		}
+        else
+        {
+            /* ...sonst deaktiviere das UI */
+            disableGUI();
+        }
+    }
+}
+
+void MainWindow::on_pbComputeSeams_clicked()
+{
+    /* Anzahl der Spalten, die entfernt werden sollen */
+    int colsToRemove = sbCols->value();
+    
+    /* Anzahl der Zeilen, die entfernt werden sollen */
+    int rowsToRemove = sbRows->value();
+    
+    /* .............. */
+	// The transport map keeps two anti-diagonals of carved images, requests that do not fit are refused before anything is cancelled
+	if(cbOptimal->isChecked() && colsToRemove >= 0 && rowsToRemove >= 0)
+	{
+		const auto mode = cbForward->isChecked() ? cvutil::EnergyMode::forward : cvutil::EnergyMode::backward;
+		const auto kernel = static_cast<cvutil::EnergyKernel>(cbEnergy->currentData().toInt());
+		const size_t memory = cvutil::physical_memory();
+		const size_t needed = cvutil::optimal_schedule_memory(originalImage.size(), colsToRemove, rowsToRemove, mode, kernel);
+		if(memory > 0 && needed > memory)
+		{
+			statusBar()->showMessage(QString("Transport map needs about %1 MiB, %2 MiB are installed. Remove fewer seams or uncheck the seam order.")
+									 .arg(static_cast<qulonglong>(needed >> 20)).arg(static_cast<qulonglong>(memory >> 20)));
+			return;
+		}
+	}
+
+	// A running job is replaced by the new one
+	worker->cancel(jobId);
+
+	SeamJob job;
+	job.id = ++jobId;
+	job.image = originalImage;
+	job.cols = colsToRemove;
+	job.rows = rowsToRemove;
+	job.mark = cbMark->isChecked();
+	job.order = cbOrder->isChecked();
+	job.forward = cbForward->isChecked();
+	job.kernel = static_cast<cvutil::EnergyKernel>(cbEnergy->currentData().toInt());
+	job.optimal = cbOptimal->isChecked();
+
+	progressBar->setRange(0, std::max(std::abs(colsToRemove) + std::abs(rowsToRemove), 1));
+	progressBar->setValue(0);
+	pbCancel->setEnabled(true);
+	statusBar()->showMessage(QString("Computing seams..."));
+
+	emit startJob(job);
+}
+
+void MainWindow::on_pbCancel_clicked()
+{
+	worker->cancel(jobId);
+	statusBar()->showMessage(QString("Cancelling..."));
+}
+
+void MainWindow::onWorkerProgress(int id, int done, int total)
+{
+	if(id != jobId)
+		return;
+
+	progressBar->setRange(0, std::max(total, 1));
+	progressBar->setValue(done);
+}
+
+void MainWindow::onWorkerPreview(int id, cv::Mat marked)
+{
+	// Results of replaced jobs are dropped
+	if(id == jobId)
+		preview->present(marked);
+}
+
+void MainWindow::onWorkerFinished(SeamResult result)
+{
+	if(result.id != jobId)
+		return;
+
+	if(result.order)
+	{
+		// Every size between the minimum and the original is now a single pass
+		columnOrder = result.columnOrder;
+		rowOrder = result.rowOrder;
+		enlarged = cv::Mat{};
+
+		// The orders shrink and enlarge by the same number of seams
+		const QSignalBlocker blockWidth(slWidth);
+		const QSignalBlocker blockHeight(slHeight);
+		slWidth->setRange(originalImage.cols - columnOrder.seams(), originalImage.cols + columnOrder.seams());
+		slWidth->setValue(originalImage.cols - sbCols->value());
+		slWidth->setEnabled(true);
+		slHeight->setRange(originalImage.rows - rowOrder.seams(), originalImage.rows + rowOrder.seams());
+		slHeight->setValue(originalImage.rows - sbRows->value());
+		slHeight->setEnabled(true);
+		preview->reserve(cv::Size(slWidth->maximum(), slHeight->maximum()));
+
+		updatePreview();
+	}
+	else
+	{
+		vertical_seams = std::move(result.vertical_seams);
+		horizontal_seams = std::move(result.horizontal_seams);
+		gray = result.gray;
+		energy = result.energy;
+		origin = result.origin;
+		interleaved = result.interleaved;
+		enlarged = result.resized;
+
+		// The marks are drawn into the copy and shown once more with all seams
+		if(!result.marked.empty())
+			preview->present(result.marked);
+	}
+
+	jobEnded(result.report.isEmpty() ? QString("Done") : QString("Done, ") + result.report);
+}
+
+void MainWindow::onWorkerCancelled(int id)
+{
+	if(id == jobId)
+		jobEnded(QString("Cancelled"));
+}
+
+void MainWindow::onWorkerFailed(int id, QString message)
+{
+	if(id == jobId)
+		jobEnded(QString("Failed: ") + message);
+}
+
+void MainWindow::jobEnded(const QString &message)
+{
+	pbCancel->setEnabled(false);
+	progressBar->setValue(0);
+	if(message.isEmpty())
+		statusBar()->clearMessage();
+	else
+		statusBar()->showMessage(message, 5000);
+}
+
+void MainWindow::on_pbRemoveSeams_clicked()
+{
+	if(cbOrder->isChecked() && !columnOrder.empty())
+	{
+		updatePreview();
+		return;
+	}
+
+	// Inserted seams were already applied by the worker, in one pass over the original
+	if(!enlarged.empty())
+	{
+		// The buffer keeps the original size in the shrunk direction, marked frames of the original are presented again later
+		preview->reserve(cv::Size(std::max(enlarged.cols, originalImage.cols), std::max(enlarged.rows, originalImage.rows)));
+		preview->present(enlarged);
+		return;
+	}
+
+	// Interleaved seams cannot be removed per direction, the index map knows where every pixel came from
+	if(interleaved)
+	{
+		carved = cvutil::gather<cv::Vec<uchar, 3>>(originalImage, origin);
+		vertical_seams.clear();
+		horizontal_seams.clear();
+		preview->present(carved);
+		return;
+	}
+
+	// One pass per direction, every pixel of the color image is copied at most once
+	carved = cvutil::remove_vertical_seams<cv::Vec<uchar, 3>>(originalImage, vertical_seams);
+	vertical_seams.clear();
+
+	carved = cvutil::remove_horizontal_seams<cv::Vec<uchar, 3>>(carved, horizontal_seams);
+	horizontal_seams.clear();
+
+	preview->present(carved);
+}
+
+void MainWindow::on_sbCols_valueChanged(int colsToRemove)
+{
+	// Without a new seam search as long as the order reaches that far
+	if(cbOrder->isChecked() && !columnOrder.empty() && std::abs(colsToRemove) <= columnOrder.seams())
+		slWidth->setValue(originalImage.cols - colsToRemove);
+}
+
+void MainWindow::on_slSize_valueChanged()
+{
+	if(!columnOrder.empty())
+		updatePreview();
+}
+
+void MainWindow::updatePreview()
+{
+	// One gather pass straight into the buffer of the preview
+	const auto size = cv::Size(slWidth->value(), slHeight->value());
+	auto frame = preview->frame(size);
+	cvutil::retarget<cv::Vec<uchar, 3>>(rgbImage, columnOrder, rowOrder, size, frame);
+	preview->present(size);
+
+	lWidth->setText(QString("Width %1").arg(size.width));
+	lHeight->setText(QString("Height %1").arg(size.height));
+}
+
+void MainWindow::setupUi()
+{
+    /* Boilerplate code */
+    /*********************************************************************************************/
+    resize(900, 600);
+    setMinimumSize(QSize(420, 300));
+    centralWidget = new QWidget(this);
+    centralWidget->setObjectName(QString("centralWidget"));
+    
+    horizontalLayout = new QHBoxLayout(centralWidget);
+    verticalLayout = new QVBoxLayout();
+    
+    pbOpenImage = new QPushButton(QString("Open Image"), centralWidget);
+    verticalLayout->addWidget(pbOpenImage);
+    
+    
+    verticalLayout_3 = new QVBoxLayout();
+    lCaption = new QLabel(QString("Remove (negative: insert)"), centralWidget);
+    lCaption->setEnabled(false);
+    verticalLayout_3->addWidget(lCaption);
+    
+    horizontalLayout_3 = new QHBoxLayout();
+    horizontalLayout_3->setObjectName(QString("horizontalLayout_3"));
+    lCols = new QLabel(QString("Cols"), centralWidget);
+    lCols->setEnabled(false);
+    lRows = new QLabel(QString("Rows"), centralWidget);
+    lRows->setEnabled(false);
+    horizontalLayout_3->addWidget(lCols);
+    horizontalLayout_3->addWidget(lRows);
+    verticalLayout_3->addLayout(horizontalLayout_3);
+    
+    horizontalLayout_2 = new QHBoxLayout();
+    sbCols = new QSpinBox(centralWidget);
+    sbCols->setEnabled(false);
+    horizontalLayout_2->addWidget(sbCols);
+    sbRows = new QSpinBox(centralWidget);
+    sbRows->setEnabled(false);
+    horizontalLayout_2->addWidget(sbRows);
+    verticalLayout_3->addLayout(horizontalLayout_2);
+    verticalLayout->addLayout(verticalLayout_3);
+    
+    pbComputeSeams = new QPushButton(QString("Compute Seams"), centralWidget);
+    pbComputeSeams->setEnabled(false);
+    verticalLayout->addWidget(pbComputeSeams);
+    
+    pbCancel = new QPushButton(QString("Cancel"), centralWidget);
+    pbCancel->setEnabled(false);
+    verticalLayout->addWidget(pbCancel);
+
+    progressBar = new QProgressBar(centralWidget);
+    progressBar->setTextVisible(false);
+    progressBar->setValue(0);
+    verticalLayout->addWidget(progressBar);
+
+    pbRemoveSeams = new QPushButton(QString("Remove Seams"), centralWidget);
+    pbRemoveSeams->setEnabled(false);
+    verticalLayout->addWidget(pbRemoveSeams);
+
+	cbMark = new QCheckBox(QString("Mark seams"), centralWidget);
+	cbMark->setEnabled(false);
+	verticalLayout->addWidget(cbMark);
+
+	cbOrder = new QCheckBox(QString("Order index / preview"), centralWidget);
+	cbOrder->setEnabled(false);
+	verticalLayout->addWidget(cbOrder);
+
+	cbForward = new QCheckBox(QString("Forward energy"), centralWidget);
+	cbForward->setEnabled(false);
+	verticalLayout->addWidget(cbForward);
+
+	// Energy function of backward energy, forward energy does not use one
+	cbEnergy = new QComboBox(centralWidget);
+	cbEnergy->addItem(QString("Sobel energy"), static_cast<int>(cvutil::EnergyKernel::sobel));
+	cbEnergy->addItem(QString("Color gradient energy"), static_cast<int>(cvutil::EnergyKernel::color_gradient));
+	cbEnergy->addItem(QString("Entropy energy"), static_cast<int>(cvutil::EnergyKernel::entropy));
+	cbEnergy->addItem(QString("Saliency energy"), static_cast<int>(cvutil::EnergyKernel::saliency));
+	cbEnergy->setEnabled(false);
+	verticalLayout->addWidget(cbEnergy);
+
+	cbOptimal = new QCheckBox(QString("Transport map seam order"), centralWidget);
+	cbOptimal->setEnabled(false);
+	verticalLayout->addWidget(cbOptimal);
+
+    verticalSpacer = new QSpacerItem(20, 40, QSizePolicy::Minimum, QSizePolicy::Expanding);
+    verticalLayout->addItem(verticalSpacer);
+    horizontalLayout->addLayout(verticalLayout);
+    
+
+    /* Vorschau mit Slidern fuer Breite und Hoehe */
+    previewLayout = new QVBoxLayout();
+    preview = new PreviewWidget(centralWidget);
+    previewLayout->addWidget(preview, 1);
+
+    widthLayout = new QHBoxLayout();
+    lWidth = new QLabel(QString("Width"), centralWidget);
+    lWidth->setMinimumWidth(80);
+    slWidth = new QSlider(Qt::Horizontal, centralWidget);
+    slWidth->setEnabled(false);
+    widthLayout->addWidget(lWidth);
+    widthLayout->addWidget(slWidth);
+    previewLayout->addLayout(widthLayout);
+
+    heightLayout = new QHBoxLayout();
+    lHeight = new QLabel(QString("Height"), centralWidget);
+    lHeight->setMinimumWidth(80);
+    slHeight = new QSlider(Qt::Horizontal, centralWidget);
+    slHeight->setEnabled(false);
+    heightLayout->addWidget(lHeight);
+    heightLayout->addWidget(slHeight);
+    previewLayout->addLayout(heightLayout);
+
+    horizontalLayout->addLayout(previewLayout, 1);
+    setCentralWidget(centralWidget);
+    /*********************************************************************************************/
+    
+    
+    /* Verbindung zwischen den Buttonklicks und den Methoden, die beim jeweiligen Buttonklick ausgefuehrt werden sollen */
+    connect(pbOpenImage,    &QPushButton::clicked, this, &MainWindow::on_pbOpenImage_clicked);  
+    connect(pbComputeSeams, &QPushButton::clicked, this, &MainWindow::on_pbComputeSeams_clicked); 
+    connect(pbRemoveSeams,  &QPushButton::clicked, this, &MainWindow::on_pbRemoveSeams_clicked);
+    connect(pbCancel,       &QPushButton::clicked, this, &MainWindow::on_pbCancel_clicked);
+	connect(sbCols, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &MainWindow::on_sbCols_valueChanged);
+	connect(slWidth,  &QSlider::valueChanged, this, &MainWindow::on_slSize_valueChanged);
+	connect(slHeight, &QSlider::valueChanged, this, &MainWindow::on_slSize_valueChanged);
+	connect(cbForward, &QCheckBox::toggled, cbEnergy, &QComboBox::setDisabled);
+}
+
+void MainWindow::enableGUI()
+{
+    lCaption->setEnabled(true);
+    
+    lCols->setEnabled(true);
+    lRows->setEnabled(true);
+    
+    sbCols->setEnabled(true);
+    sbRows->setEnabled(true);
+    
+    pbComputeSeams->setEnabled(true);
+    pbRemoveSeams->setEnabled(true);
+
+	cbMark->setEnabled(true);
+	cbOrder->setEnabled(true);
+	cbForward->setEnabled(true);
+	cbEnergy->setEnabled(!cbForward->isChecked());
+	cbOptimal->setEnabled(true);
+    
+    sbRows->setMinimum(0);
+    sbRows->setMaximum(originalImage.rows);
+    sbRows->setValue(2);
+    
+    sbCols->setMinimum(0);
+    sbCols->setMaximum(originalImage.cols);
+    sbCols->setValue(2);
+}
+
+void MainWindow::disableGUI()
+{
+    lCaption->setEnabled(false);
+    
+    lCols->setEnabled(false);
+    lRows->setEnabled(false);
+    
+    sbCols->setEnabled(false);
+    sbRows->setEnabled(false);
+    
+    pbComputeSeams->setEnabled(false);
+    pbRemoveSeams->setEnabled(false);
+
+	cbMark->setEnabled(false);
+	cbOrder->setEnabled(false);
+	cbForward->setEnabled(false);
+	cbEnergy->setEnabled(false);
+	cbOptimal->setEnabled(false);
+}
@@ -0,0 +1,145 @@
+#ifndef MAINWINDOW_HPP
+#define MAINWINDOW_HPP
+
+#include <QMainWindow>
+#include <QFileDialog>
+#include <QPushButton>
+#include <QBoxLayout>
+#include <QSpinBox>
+#include <QLabel>
+#include <QGroupBox>
+#include <QStatusBar>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QSlider>
+#include <QProgressBar>
+#include <QThread>
+
+#include "PreviewWidget.hpp"
+#include "QtOpencvCore.hpp"
+#include "SeamWorker.hpp"
+#include "seam_order.h"
+#include "opencv2/core/core.hpp"
+#include "opencv2/highgui/highgui.hpp"
+
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+    
+public:
+    
+    /* Konstruktor */
+    explicit MainWindow(QWidget *parent = 0);
+    
+    /* Destruktor */
+    ~MainWindow();
+
+signals:
+
+    /* Startet eine Berechnung im Worker-Thread */
+    void startJob(SeamJob job);
+    
+private slots:  
+    
+    /* Funktionen werden ausgeloest, wenn auf den entsprechenden Button geklickt wird */
+    void on_pbOpenImage_clicked();
+    void on_pbComputeSeams_clicked();
+    void on_pbRemoveSeams_clicked();
+	void on_sbCols_valueChanged(int colsToRemove);
+	void on_slSize_valueChanged();
+	void on_pbCancel_clicked();
+
+	/* Rueckmeldungen des Workers */
+	void onWorkerProgress(int id, int done, int total);
+	void onWorkerPreview(int id, cv::Mat marked);
+	void onWorkerFinished(SeamResult result);
+	void onWorkerCancelled(int id);
+	void onWorkerFailed(int id, QString message);
+    
+private:
+
+    
+    /* UI Komponenten */
+    QWidget     *centralWidget;
+    
+    QHBoxLayout *horizontalLayout;
+    QHBoxLayout *horizontalLayout_2;
+    QHBoxLayout *horizontalLayout_3;
+    QVBoxLayout *verticalLayout;
+    QVBoxLayout *verticalLayout_3;
+    QVBoxLayout *previewLayout;
+    QHBoxLayout *widthLayout;
+    QHBoxLayout *heightLayout;
+    
+    QPushButton *pbOpenImage;
+    QPushButton *pbRemoveSeams;
+    QPushButton *pbComputeSeams;
+    QPushButton *pbCancel;
+
+    QProgressBar *progressBar;
+    
+    QLabel      *lCaption;
+    QLabel      *lCols;
+    QLabel      *lRows;
+    QLabel      *lWidth;
+    QLabel      *lHeight;
+    
+    QSpinBox    *sbCols;
+    QSpinBox    *sbRows;
+
+    QSlider     *slWidth;
+    QSlider     *slHeight;
+
+    PreviewWidget *preview;
+    
+    QSpacerItem *verticalSpacer;
+
+	QCheckBox *cbMark;
+	QCheckBox *cbOrder;
+	QCheckBox *cbForward;
+	QComboBox *cbEnergy;
+	QCheckBox *cbOptimal;
+    /*****************************************/
+    
+    /* Originalbild */
+    cv::Mat         originalImage;
+    /* Eventuell weitere Klassenattribute */
+	/* Originalbild in RGB-Reihenfolge fuer die Vorschau */
+	cv::Mat			rgbImage;
+	cv::Mat			gray;
+	cv::Mat			energy;
+	cv::Mat			carved;
+	/* Originale (Zeile, Spalte) jedes Pixels von gray, CV_32SC2 */
+	cv::Mat			origin;
+	/* Entfernte Naehte, delta-kodiert in einem Speicherblock */
+	cvutil::SeamList horizontal_seams{};
+	cvutil::SeamList vertical_seams{};
+	/* Naht-Richtungen abwechselnd entfernt (Reihenfolge der Transportkarte), dann gilt nur origin */
+	bool			interleaved = false;
+	/* Vergroessertes Bild, falls Naehte eingefuegt wurden */
+	cv::Mat			enlarged;
+	/* Entfernungsreihenfolge der Pixel fuer sofortiges Aendern von Breite und Hoehe */
+	cvutil::SeamOrder columnOrder{};
+	cvutil::SeamOrder rowOrder{};
+
+	/* Berechnungen laufen im Worker-Thread, jobId ist die Nummer der zuletzt gestarteten */
+	QThread         workerThread;
+	SeamWorker     *worker;
+	int             jobId = 0;
+
+    /* Beendet die Anzeige einer laufenden Berechnung */
+    void jobEnded(const QString &message);
+
+    /* Zeigt das Bild in der an den Slidern eingestellten Groesse an */
+    void updatePreview();
+
+    /* Methode initialisiert die UI */
+    void setupUi();
+    
+    /* Methoden aktivieren bzw. deaktivieren die UI */
+    void enableGUI();
+    void disableGUI();
+};
+
+#endif // MAINWINDOW_HPP
@@ -0,0 +1,68 @@
+#include "PreviewWidget.hpp"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+PreviewWidget::PreviewWidget(QWidget *parent) :
+    QWidget(parent)
+{
+    setMinimumSize(QSize(160, 120));
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    /* the whole widget is painted in every frame */
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void PreviewWidget::reserve(cv::Size size)
+{
+    if(buffer.width() != size.width || buffer.height() != size.height)
+        buffer = QImage(size.width, size.height, QImage::Format_RGB888);
+    visible = QSize();
+    updateGeometry();
+    update();
+}
+
+cv::Mat PreviewWidget::frame(cv::Size size)
+{
+    if(size.width > buffer.width() || size.height > buffer.height())
+        throw std::invalid_argument{"Preview frame larger than the reserved buffer"};
+
+    /* rows keep the stride of the full buffer */
+    return cv::Mat(size.height, size.width, CV_8UC3, buffer.bits(), static_cast<size_t>(buffer.bytesPerLine()));
+}
+
+void PreviewWidget::present(cv::Size size)
+{
+    visible = QSize(size.width, size.height);
+    update();
+}
+
+void PreviewWidget::present(const cv::Mat &img)
+{
+    auto target = frame(img.size());
+    cv::cvtColor(img, target, cv::COLOR_BGR2RGB);
+    present(img.size());
+}
+
+QSize PreviewWidget::sizeHint() const
+{
+    return buffer.isNull() ? QSize(480, 360) : buffer.size().boundedTo(QSize(1280, 800));
+}
+
+void PreviewWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+    if(visible.isEmpty())
+        return;
+
+    /* one scale for all frames, so that the original fits and carved frames keep their pixel size */
+    const double scale = std::min(1.0, std::min(double(width()) / buffer.width(), double(height()) / buffer.height()));
+    const QSize scaled(qRound(visible.width() * scale), qRound(visible.height() * scale));
+
+    /* top left aligned, so the right and bottom edge move with the sliders */
+    painter.drawImage(QRect(QPoint(0, 0), scaled), buffer, QRect(QPoint(0, 0), visible));
+}
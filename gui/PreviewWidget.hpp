@@ -0,0 +1,60 @@
+#ifndef PREVIEWWIDGET_HPP
+#define PREVIEWWIDGET_HPP
+
+#include <QImage>
+#include <QWidget>
+
+#include "opencv2/core/core.hpp"
+
+
+/**
+ * @brief The PreviewWidget class Shows carved images inside the main window.
+ * Frames are written directly into one persistent QImage that is allocated for the largest frame,
+ * so a new frame costs neither an allocation nor a QImage/QPixmap conversion.
+ */
+class PreviewWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+
+    explicit PreviewWidget(QWidget *parent = 0);
+
+    /**
+     * @brief Allocates the buffer for frames up to the given size and clears the view
+     * @param size is the largest frame size, usually the size of the original image
+     */
+    void reserve(cv::Size size);
+
+    /**
+     * @brief Gives access to the buffer for the next frame
+     * @param size is the frame size, at most the reserved size
+     * @return 8UC3 cv::Mat in RGB order that shares its data with the buffer
+     */
+    cv::Mat frame(cv::Size size);
+
+    /**
+     * @brief Shows the frame of the given size that was written into the buffer
+     * @param size is the size passed to frame()
+     */
+    void present(cv::Size size);
+
+    /**
+     * @brief Copies an 8UC3 BGR image into the buffer and shows it
+     * @param img is the image, at most the reserved size
+     */
+    void present(const cv::Mat &img);
+
+    QSize sizeHint() const override;
+
+protected:
+
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+
+    QImage buffer;
+    QSize  visible;
+};
+
+#endif // PREVIEWWIDGET_HPP
@@ -0,0 +1,164 @@
+#include "SeamWorker.hpp"
+
+#include "seam_carver.h"
+
+#include <cstdlib>
+#include <exception>
+
+SeamWorker::SeamWorker(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void SeamWorker::cancel(int id)
+{
+    /* only ever raise the limit, an older cancellation must not revive a newer job */
+    int current = cancelledUpTo.load();
+    while(current < id && !cancelledUpTo.compare_exchange_weak(current, id))
+    {
+    }
+}
+
+bool SeamWorker::proceed(const SeamJob &job, int done, int total, const cv::Mat &marked)
+{
+    if(job.id <= cancelledUpTo.load())
+        return false;
+
+    if(throttle.elapsed() >= previewInterval || done == total)
+    {
+        throttle.restart();
+        emit progress(job.id, done, total);
+        if(!marked.empty())
+            emit preview(job.id, marked.clone());
+    }
+    return true;
+}
+
+void SeamWorker::run(SeamJob job)
+{
+    if(job.id <= cancelledUpTo.load())
+    {
+        emit cancelled(job.id);
+        return;
+    }
+
+    /* exceptions must not leave the slot, the event loop of the thread would be terminated */
+    try
+    {
+        compute(job);
+    }
+    catch(const std::exception &e)
+    {
+        emit failed(job.id, QString(e.what()));
+    }
+}
+
+void SeamWorker::compute(const SeamJob &job)
+{
+    SeamResult result;
+    result.id = job.id;
+    result.order = job.order;
+
+    const int total = std::abs(job.cols) + std::abs(job.rows);
+    const auto mode = job.forward ? cvutil::EnergyMode::forward : cvutil::EnergyMode::backward;
+    throttle.start();
+    emit progress(job.id, 0, total);
+
+    // Carve once down to the smallest size, afterwards every size up to the original plus the seams is a single pass.
+    // Inserting seams needs the same orders, the pixels removed first are the ones that are doubled.
+    if(job.order || job.cols < 0 || job.rows < 0)
+    {
+        const int cols = std::abs(job.cols);
+        const int rows = std::abs(job.rows);
+        result.columnOrder = cvutil::SeamOrder{job.image, job.image.cols - cols, cvutil::Orientation::vertical, mode, job.kernel,
+                [this, &job, total] (int done) { return proceed(job, done, total, cv::Mat()); }};
+        if(result.columnOrder.empty() && cols > 0)
+        {
+            emit cancelled(job.id);
+            return;
+        }
+
+        result.rowOrder = cvutil::SeamOrder{job.image, job.image.rows - rows, cvutil::Orientation::horizontal, mode, job.kernel,
+                [this, &job, cols, total] (int done) { return proceed(job, cols + done, total, cv::Mat()); }};
+        if(result.rowOrder.empty() && rows > 0)
+        {
+            emit cancelled(job.id);
+            return;
+        }
+
+        if(!job.order)
+            cvutil::retarget<cv::Vec<uchar, 3>>(job.image, result.columnOrder, result.rowOrder,
+                                                cv::Size(job.image.cols - job.cols, job.image.rows - job.rows), result.resized);
+        emit finished(result);
+        return;
+    }
+
+    // All vertical seams first, or interleaved in the order of the transport map
+    std::vector<cvutil::Orientation> schedule(static_cast<size_t>(job.cols), cvutil::Orientation::vertical);
+    schedule.resize(static_cast<size_t>(total), cvutil::Orientation::horizontal);
+    int offset = 0;
+    int steps = total;
+    if(job.optimal)
+    {
+        // The cells of the map and the seams of the fixed order count as progress before the seams
+        const int cells = (job.cols + 1) * (job.rows + 1);
+        steps = cells + 2 * total;
+
+        QElapsedTimer timer;
+        timer.start();
+        const auto optimal = cvutil::optimal_schedule(job.image, job.cols, job.rows, mode, job.kernel,
+                [this, &job, steps] (int done, int) { return proceed(job, done, steps, cv::Mat()); });
+        if(static_cast<int>(optimal.order.size()) != total)
+        {
+            emit cancelled(job.id);
+            return;
+        }
+        const qint64 optimalTime = timer.restart();
+        const auto fixed = cvutil::fixed_schedule(job.image, job.cols, job.rows, mode, job.kernel,
+                [this, &job, cells, steps] (int done, int) { return proceed(job, cells + done, steps, cv::Mat()); });
+        if(static_cast<int>(fixed.order.size()) != total)
+        {
+            emit cancelled(job.id);
+            return;
+        }
+        const qint64 fixedTime = timer.elapsed();
+
+        // The transport map is greedy and can lose against removing all vertical seams first
+        offset = cells + total;
+        result.interleaved = optimal.cost <= fixed.cost;
+        if(result.interleaved)
+            schedule = optimal.order;
+        result.report = QString("transport map order energy %1 (%2 ms), fixed order %3 (%4 ms), %5 order removed")
+                .arg(optimal.cost).arg(optimalTime).arg(fixed.cost).arg(fixedTime)
+                .arg(result.interleaved ? QString("transport map") : QString("fixed"));
+    }
+
+    // All buffers are allocated once, every seam only updates them incrementally
+    auto carver = cvutil::SeamCarver{job.image, mode, job.kernel};
+    if(job.mark)
+        result.marked = job.image.clone();
+
+    result.vertical_seams.reserve(static_cast<size_t>(job.cols), job.image.rows);
+    result.horizontal_seams.reserve(static_cast<size_t>(job.rows), job.image.cols);
+    for(size_t i = 0; i < schedule.size(); ++i)
+    {
+        const bool vertical = schedule[i] == cvutil::Orientation::vertical;
+        (vertical ? result.vertical_seams : result.horizontal_seams).push_back(carver.step(schedule[i]));
+
+        // Mark found seams
+        if(job.mark)
+            for(const auto& pixel : carver.original_seam())
+                result.marked.at<cv::Vec<uchar, 3>>(pixel) = vertical ? cv::Vec<uchar, 3>(255, 0, 0) : cv::Vec<uchar, 3>(0, 0, 255);
+
+        if(!proceed(job, offset + static_cast<int>(i) + 1, steps, result.marked))
+        {
+            emit cancelled(job.id);
+            return;
+        }
+    }
+
+    result.gray = carver.gray();
+    result.energy = carver.energy();
+    result.origin = carver.index();
+    emit finished(result);
+}
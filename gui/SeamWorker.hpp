@@ -0,0 +1,118 @@
+#ifndef SEAMWORKER_HPP
+#define SEAMWORKER_HPP
+
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+#include "seam_list.h"
+#include "seam_order.h"
+#include "seam_schedule.h"
+
+
+/**
+ * @brief The SeamJob struct Input of one seam computation.
+ */
+struct SeamJob
+{
+    int     id = 0;         // increasing per job, identifies results and cancellations
+    cv::Mat image;          // 8UC3 original, only read
+    int     cols = 0;       // vertical seams to compute, negative values insert seams
+    int     rows = 0;       // horizontal seams to compute, negative values insert seams
+    bool    mark = false;   // draw the seams into a copy of the image
+    bool    order = false;  // compute seam orders instead of seam lists
+    bool    forward = false;// search seams with forward instead of backward energy
+    cvutil::EnergyKernel kernel = cvutil::EnergyKernel::sobel; // energy function of backward energy
+    bool    optimal = false;// interleave the seams by the transport map if that beats all vertical ones first
+};
+
+/**
+ * @brief The SeamResult struct Output of a finished seam computation.
+ */
+struct SeamResult
+{
+    int id = 0;
+    bool order = false;
+
+    /* seam lists, if !order, delta encoded */
+    cvutil::SeamList vertical_seams;
+    cvutil::SeamList horizontal_seams;
+    cv::Mat gray;
+    cv::Mat energy;
+    cv::Mat origin;
+    cv::Mat marked;     // only if the job marked seams
+    bool interleaved = false;   // the seams were removed in the transport map order, not vertical ones first
+    cv::Mat resized;    // the enlarged image, if the job inserted seams
+    QString report;     // cost and time of the transport map against the fixed order
+
+    /* seam orders, if order */
+    cvutil::SeamOrder columnOrder;
+    cvutil::SeamOrder rowOrder;
+};
+
+Q_DECLARE_METATYPE(SeamJob)
+Q_DECLARE_METATYPE(SeamResult)
+Q_DECLARE_METATYPE(cv::Mat)
+
+
+/**
+ * @brief The SeamWorker class Runs seam computations on the thread it was moved to.
+ * Jobs arrive through the queued run() slot and are processed one after the other. Progress and marked previews
+ * are reported at most every previewInterval milliseconds. Cancellation is cooperative and checked between seams.
+ */
+class SeamWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit SeamWorker(QObject *parent = 0);
+
+    /**
+     * @brief Cancels all jobs up to the given id, the running one stops before its next seam. Thread safe.
+     * @param id is the id of the latest job to cancel
+     */
+    void cancel(int id);
+
+    /* minimum time between two progress or preview signals */
+    static const int previewInterval = 100;
+
+public slots:
+
+    /**
+     * @brief Computes the seams or seam orders of a job
+     * @param job is the job, skipped if it was cancelled before it started
+     */
+    void run(SeamJob job);
+
+signals:
+
+    void progress(int id, int done, int total);
+    void preview(int id, cv::Mat marked);
+    void finished(SeamResult result);
+    void cancelled(int id);
+    void failed(int id, QString message);
+
+private:
+
+    /**
+     * @brief Does the work of run(), reports the outcome through finished() or cancelled()
+     */
+    void compute(const SeamJob &job);
+
+    /**
+     * @brief Reports the progress after a seam, throttled
+     * @return false if the job was cancelled
+     */
+    bool proceed(const SeamJob &job, int done, int total, const cv::Mat &marked);
+
+    std::atomic<int> cancelledUpTo{0};
+    QElapsedTimer    throttle;
+};
+
+#endif // SEAMWORKER_HPP
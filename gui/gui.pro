@@ -0,0 +1,51 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-10-16T14:52:53
+#
+#-------------------------------------------------
+
+CONFIG += c++1z
+
+QT += core gui
+QT += widgets
+
+TARGET = SeamCarving
+TEMPLATE = app
+
+
+SOURCES += main.cpp\
+        MainWindow.cpp \
+        QtOpencvCore.cpp \
+        PreviewWidget.cpp \
+        SeamWorker.cpp
+
+HEADERS  += MainWindow.hpp \
+        QtOpencvCore.hpp \
+        PreviewWidget.hpp \
+        SeamWorker.hpp
+
+FORMS    +=
+
+include(../core/core.pri)
+
+macx {
+
+    # MAC Compiler Flags
+}
+
+win32 {
+    # Windows Compiler Flags
+}
+
+
+unix {
+
+
+#	INCLUDEPATH += /usr/include
+
+#	LIBS += -L/usr/local/lib \
+	LIBS +=	-lopencv_highgui
+
+#	QMAKE_CXXFLAGS += -std=c++11 -Wall -pedantic -Wno-unknown-pragmas
+#	QMAKE_CXXFLAGS_WARN_ON = -Wno-unused-variable -Wno-reorder
+}
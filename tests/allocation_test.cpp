@@ -0,0 +1,144 @@
+#include "seam_carver.h"
+#include "thread_pool.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+
+/*
+ * Checks that carving never allocates once the SeamCarver is constructed and its masks or pyramids are set. Every global
+ * operator new is counted: the containers, seam finders and thread pool tasks. The buffers of cv::Mat come from
+ * cv::fastMalloc and are not counted, the carver creates all of its matrices in the constructor and in set_masks().
+ */
+
+namespace
+{
+	std::atomic<long> allocations{0};
+
+	void* allocate(std::size_t size)
+	{
+		++allocations;
+		if(auto p = std::malloc(size == 0 ? 1 : size))
+			return p;
+		throw std::bad_alloc{};
+	}
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { ++allocations; return std::malloc(size == 0 ? 1 : size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { ++allocations; return std::malloc(size == 0 ? 1 : size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+	/**
+	 * @brief noisy_image A color image without flat regions, so the seams wander.
+	 */
+	cv::Mat noisy_image(int rows, int cols)
+	{
+		auto image = cv::Mat(rows, cols, CV_8UC3);
+		auto state = 12345u;
+		for(int r = 0; r < rows; ++r)
+			for(int c = 0; c < cols; ++c)
+			{
+				state = state * 1103515245u + 12345u;
+				image.at<cv::Vec3b>(r, c) = cv::Vec3b(static_cast<uchar>(state >> 8), static_cast<uchar>(state >> 16), static_cast<uchar>(state >> 24));
+			}
+		return image;
+	}
+
+	/**
+	 * @brief check Runs the carving of one scenario and reports the allocations it made.
+	 * @return True if nothing was allocated.
+	 */
+	bool check(const std::string& name, const std::function<void()>& carve)
+	{
+		const auto before = allocations.load();
+		carve();
+		const auto count = allocations.load() - before;
+		std::cout << (count == 0 ? "PASS: " : "FAIL: ") << name << ", " << count << " allocations" << std::endl;
+		return count == 0;
+	}
+}
+
+int main()
+{
+	// Wider and higher than 4 blocks of RouteMatrix::block_cells, so the searches split across the threads in both orientations
+	const auto image = noisy_image(1100, 1200);
+	auto protect = cv::Mat(image.size(), CV_8UC1, cv::Scalar(0));
+	protect(cv::Range(100, 400), cv::Range(100, 400)).setTo(cv::Scalar(255));
+	auto remove = cv::Mat(image.size(), CV_8UC1, cv::Scalar(0));
+	remove(cv::Range(500, 700), cv::Range(700, 710)).setTo(cv::Scalar(255));
+
+	const std::pair<cvutil::EnergyKernel, std::string> kernels[] = {
+		{cvutil::EnergyKernel::sobel, "Sobel"}, {cvutil::EnergyKernel::color_gradient, "color gradient"},
+		{cvutil::EnergyKernel::entropy, "entropy"}, {cvutil::EnergyKernel::saliency, "saliency"}};
+
+	auto passed = true;
+	for(const auto threads : {1, 4})
+	{
+		cvutil::set_thread_count(threads);
+		const auto suffix = std::string{" ("} + std::to_string(threads) + (threads == 1 ? " thread)" : " threads)");
+
+		for(const auto mode : {cvutil::EnergyMode::backward, cvutil::EnergyMode::forward})
+		{
+			// Forward energy ignores the kernel
+			for(const auto& [kernel, kernel_name] : kernels)
+			{
+				if(mode == cvutil::EnergyMode::forward && kernel != cvutil::EnergyKernel::sobel)
+					continue;
+				const auto energy = mode == cvutil::EnergyMode::backward ? "backward " + kernel_name : std::string{"forward"};
+
+				auto vertical = cvutil::SeamCarver{image, mode, kernel};
+				passed &= check("vertical seams, " + energy + suffix, [&vertical] {
+					vertical.carve(10, cvutil::Orientation::vertical);
+				});
+
+				auto horizontal = cvutil::SeamCarver{image, mode, kernel};
+				passed &= check("horizontal seams, " + energy + suffix, [&horizontal] {
+					horizontal.carve(10, cvutil::Orientation::horizontal);
+				});
+
+				auto alternating = cvutil::SeamCarver{image, mode, kernel};
+				passed &= check("alternating orientations, " + energy + suffix, [&alternating] {
+					for(int i = 0; i < 5; ++i)
+					{
+						alternating.step(cvutil::Orientation::vertical);
+						alternating.step(cvutil::Orientation::horizontal);
+					}
+				});
+
+				auto masked = cvutil::SeamCarver{image, mode, kernel};
+				masked.set_masks(protect, remove);
+				passed &= check("masks, " + energy + suffix, [&masked] {
+					masked.carve(5, cvutil::Orientation::vertical);
+					masked.carve(5, cvutil::Orientation::horizontal);
+					masked.step(cvutil::Orientation::vertical);
+				});
+			}
+
+			const auto energy = std::string{mode == cvutil::EnergyMode::backward ? "backward" : "forward"};
+			auto coarse = cvutil::SeamCarver{image, mode};
+			coarse.coarse_to_fine(2, 4);
+			passed &= check("coarse to fine, " + energy + suffix, [&coarse] {
+				for(int i = 0; i < 5; ++i)
+				{
+					coarse.carve(2, cvutil::Orientation::vertical);
+					coarse.carve(2, cvutil::Orientation::horizontal);
+				}
+			});
+		}
+	}
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
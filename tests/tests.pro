@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Tests of the seam carving core, run with make check
+#
+#-------------------------------------------------
+
+CONFIG += c++1z console testcase
+CONFIG -= app_bundle
+
+QT -= core gui
+
+TARGET = allocation_test
+TEMPLATE = app
+
+
+SOURCES += allocation_test.cpp
+
+include(../core/core.pri)